@@ -0,0 +1,816 @@
+/**
+ * Benchmarks for the Minesweeper Solver, run with "make bench". No screen is needed: boards are played
+ * against an in-memory game, and screenshots are drawn the way the game draws them.
+ * Results are printed as CSV, one line per benchmark:
+ * * name
+ * * ns_per_op: nanoseconds per operation (median of a few samples)
+ * * allocs_per_op: heap allocations per operation
+ * * clicks_per_op: clicks per operation (only used by the whole-game benchmarks)
+ * When a baseline file is given, any benchmark doing more allocations or clicks than before is a regression,
+ * and the program returns 1. These are exact. Timing isn't, so a benchmark slower than the baseline by more
+ * than the tolerance is only reported, unless --strict is given.
+ */
+
+// Count every heap allocation, and leave main() out of the solver
+#define COUNT_ALLOCATIONS
+#define MINESWEEPER_NO_MAIN
+#include "minesweeper.cpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+// Result of a single benchmark
+struct BenchResult {
+    std::string name;
+    double ns_per_op;
+    double allocs_per_op;
+    double clicks_per_op;
+};
+
+/**
+ * This function keeps the compiler from optimizing a value away
+ * @param value Value to be kept
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Samples taken by measure(), and the least time every one of them takes
+const int SAMPLES = 11;
+const double SAMPLE_NS = 5e7;
+
+/**
+ * This function times an operation. The amount of iterations is doubled until a sample takes at least
+ * SAMPLE_NS, then the median of SAMPLES samples is kept, so a few samples disturbed by the machine don't
+ * move the result.
+ * @param name Benchmark name
+ * @param op Operation to be timed
+ * @param ops_per_call How many operations a single call to op does. It's 1 by default
+ * @param clicks_per_op Clicks per operation to be reported. It's 0 by default
+ * @return returns the benchmark result
+ */
+template <typename F>
+BenchResult measure(const std::string& name, F&& op, int ops_per_call = 1, double clicks_per_op = 0) {
+    typedef std::chrono::steady_clock Clock;
+    // First call warms everything up, and tells the allocations
+    std::size_t allocations = allocation_counter;
+    op();
+    double allocs_per_op = (double)(allocation_counter - allocations) / ops_per_call;
+
+    long iterations = 1;
+    std::vector<double> samples;
+    while ((int)samples.size() < SAMPLES) {
+        auto start = Clock::now();
+        for (long i = 0; i < iterations; i++) op();
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (elapsed < SAMPLE_NS && samples.size() == 0) {
+            iterations *= 2;
+            continue;
+        }
+        samples.push_back(elapsed / iterations / ops_per_call);
+    }
+    std::nth_element(samples.begin(), samples.begin() + SAMPLES/2, samples.end());
+    return {name, samples[SAMPLES/2], allocs_per_op, clicks_per_op};
+}
+
+// In-memory game, with the bombs placed from a fixed seed
+struct SimulatedGame {
+    int rows;
+    int cols;
+    std::vector<char> bombs;
+    std::vector<char> revealed;
+    std::vector<char> flagged;
+    bool lost = false;
+    // Bomb hit, if any
+    int exploded = -1;
+
+    /**
+     * Creates the game and reveals the first tile. The 3x3 area around the first tile is kept free of bombs.
+     */
+    SimulatedGame(int rows, int cols, int bomb_count, unsigned seed) : rows(rows), cols(cols), bombs(rows*cols, 0), revealed(rows*cols, 0), flagged(rows*cols, 0) {
+        std::mt19937 random(seed);
+        int first_x = rows/2;
+        int first_y = cols/2;
+        for (int placed = 0; placed < bomb_count; ) {
+            int cell = random() % (rows*cols);
+            if (bombs[cell] || (std::abs(cell/cols - first_x) <= 1 && std::abs(cell%cols - first_y) <= 1)) continue;
+            bombs[cell] = 1;
+            placed++;
+        }
+        reveal(first_x, first_y);
+    }
+
+    bool inside(int x, int y) const {
+        return x >= 0 && x < rows && y >= 0 && y < cols;
+    }
+
+    int around(int x, int y, const std::vector<char>& tiles) const {
+        int count = 0;
+        for (int i = x-1; i <= x+1; i++) {
+            for (int j = y-1; j <= y+1; j++) {
+                if (inside(i, j) && tiles[i*cols + j]) count++;
+            }
+        }
+        return count;
+    }
+
+    void reveal(int x, int y) {
+        if (!inside(x, y) || revealed[x*cols + y] || flagged[x*cols + y]) return;
+        if (bombs[x*cols + y]) {
+            lost = true;
+            exploded = x*cols + y;
+            return;
+        }
+        revealed[x*cols + y] = 1;
+        if (around(x, y, bombs) > 0) return;
+        for (int i = x-1; i <= x+1; i++) {
+            for (int j = y-1; j <= y+1; j++) reveal(i, j);
+        }
+    }
+
+    void perform(const Move& move) {
+        int cell = move.x*cols + move.y;
+        if (move.action == MARK_BOMB) {
+            flagged[cell] = 1;
+        } else if (move.action == REVEAL_TILE) {
+            reveal(move.x, move.y);
+        } else if (revealed[cell] && around(move.x, move.y, flagged) == around(move.x, move.y, bombs)) {
+            // Chording only does something when the flags around the tile match its number
+            for (int i = move.x-1; i <= move.x+1; i++) {
+                for (int j = move.y-1; j <= move.y+1; j++) reveal(i, j);
+            }
+        }
+    }
+
+    bool won() const {
+        for (int cell = 0; cell < rows*cols; cell++) {
+            if (!revealed[cell] && !bombs[cell]) return false;
+        }
+        return true;
+    }
+};
+
+// A screenshot in the same layout the recognition expects, with one or more boards side by side
+struct Screenshot {
+    int board_width;
+    int width;
+    int height;
+    std::vector<std::uint8_t> pixels;
+    Mat img;
+    // State drawn on every tile of every board, so only the tiles changed are drawn again
+    std::vector<std::vector<int>> shown;
+
+    Screenshot(int rows, int cols, int boards = 1) : board_width(34+25*cols+cols/2+40), width(board_width*boards), height(318+25*rows+40), pixels(width*height*4, 0), shown(boards, std::vector<int>(rows*cols, -1)) {
+        img = Mat(height, width, CV_8UC4, &pixels[0]);
+    }
+
+    // Origin of a board drawn next to the others
+    BoardOrigin origin(int board) const {
+        BoardOrigin result;
+        result.x = board*board_width;
+        return result;
+    }
+
+    /**
+     * Draws the game on one of the boards. Bombs are only shown once the game is lost.
+     */
+    void draw(const SimulatedGame& game, int board = 0) {
+        for (int i = 0; i < game.rows; i++) {
+            for (int j = 0; j < game.cols; j++) {
+                int cell = i*game.cols + j;
+                int state = TILE_UNDISCOVERED;
+                if (game.revealed[cell]) state = game.around(i, j, game.bombs);
+                else if (game.lost && cell == game.exploded) state = TILE_EXPLODED;
+                else if (game.lost && game.bombs[cell] && !game.flagged[cell]) state = TILE_MINE;
+                else if (game.flagged[cell]) state = TILE_FLAG;
+                if (shown[board][cell] == state) continue;
+                shown[board][cell] = state;
+                drawTile(i, j, state, origin(board));
+            }
+        }
+    }
+
+    /**
+     * Draws a tile, centered on the row the recognition reads. Undiscovered tiles have a white border on
+     * their top and left, numbers are drawn in the colors of the original game.
+     */
+    void drawTile(int i, int j, int state, const BoardOrigin& origin = BoardOrigin()) {
+        // RGB colors for numbers 1 to 8
+        static const int number_colors[9][3] = {{0, 0, 0}, {0, 0, 255}, {0, 128, 0}, {255, 0, 0}, {0, 0, 128}, {128, 0, 0}, {0, 128, 128}, {0, 0, 0}, {128, 128, 128}};
+        int left = 34+25*j + j/2 + origin.x;
+        int y = 318+25*i + origin.y;
+        bool raised = state == TILE_UNDISCOVERED || state == TILE_FLAG;
+        for (int dy = -12; dy <= 12; dy++) {
+            for (int dx = 0; dx < 25; dx++) {
+                if (state == TILE_EXPLODED) setPixel(left+dx, y+dy, 255, 0, 0);
+                else if (raised && (dx < 2 || dy < -10)) setPixel(left+dx, y+dy, 255, 255, 255);
+                else if (raised && (dx > 22 || dy > 10)) setPixel(left+dx, y+dy, 128, 128, 128);
+                else setPixel(left+dx, y+dy, 192, 192, 192);
+            }
+        }
+        if (state >= 1 && state <= 8) {
+            fill(left+9, y-6, left+15, y+6, number_colors[state]);
+        } else if (state == TILE_FLAG) {
+            static const int red[3] = {255, 0, 0};
+            static const int black[3] = {0, 0, 0};
+            fill(left+8, y-7, left+14, y-1, red);
+            fill(left+6, y+3, left+18, y+5, black);
+        } else if (state == TILE_MINE || state == TILE_EXPLODED) {
+            for (int dy = -5; dy <= 5; dy++) {
+                for (int dx = -5; dx <= 5; dx++) {
+                    if (dx*dx + dy*dy <= 25) setPixel(left+12+dx, y+dy, 0, 0, 0);
+                }
+            }
+        }
+    }
+
+    void fill(int x0, int y0, int x1, int y1, const int color[3]) {
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) setPixel(x, y, color[0], color[1], color[2]);
+        }
+    }
+
+    void setPixel(int x, int y, int R, int G, int B) {
+        img.at<Vec4b>(y, x) = Vec4b(B, G, R, 255);
+    }
+};
+
+/**
+ * This function builds a board from text, one string per row
+ * @param board Board to be filled
+ * @param rows Text rows
+ */
+template <typename BoardT>
+void boardFromText(BoardT& board, const std::vector<std::string>& rows) {
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) board.at(i, j) = rows[i][j];
+    }
+}
+
+/**
+ * This function plays a whole game against the in-memory game, the same way play() does on screen:
+ * solver runs, planned moves and a new screenshot parsed after every batch with revealed tiles.
+ * @param board Board to be used, with every tile undiscovered
+ * @param game Game to be played
+ * @param screen Screenshot buffer for the game size
+ * @param flags Planner flags mode
+ * @param theme Theme to read the tiles with, if any
+ * @param result How the game ended, as told by gameState()
+ * @param speculator Speculator solving ahead of time while the moves are performed, if any
+ * @return returns the amount of clicks done
+ */
+template <typename BoardT>
+int playSimulated(BoardT& board, SimulatedGame& game, Screenshot& screen, bool flags, const Theme* theme, GAME_STATE& result, Speculator<BoardT>* speculator = nullptr) {
+    screen.draw(game);
+    parseBoard(screen.img, board, false, BoardOrigin(), theme);
+    int mines = std::count(game.bombs.begin(), game.bombs.end(), 1);
+    SolverState state(board.size());
+    state.mines = mines;
+    Planner planner;
+    planner.flags = flags;
+    int clicks = 0;
+    result = solveGame(board, state, planner, [&](const std::vector<Move>& planned) {
+        bool revealed = false;
+        for (auto &move : planned) {
+            game.perform(move);
+            if (move.action != MARK_BOMB) revealed = true;
+        }
+        clicks += planned.size();
+        if (revealed) {
+            screen.draw(game);
+            parseBoard(screen.img, board, false, BoardOrigin(), theme);
+        }
+        // The face changes as soon as the game is over
+        return gameState(board, mines, game.lost || game.won());
+    }, speculator);
+    return clicks;
+}
+
+/**
+ * This function benchmarks whole games for a board size
+ * @param results List where the result is appended
+ * @param name Benchmark name
+ * @param empty Board with every tile undiscovered, copied for every game
+ * @param bombs Amount of bombs
+ * @param games Amount of games, each one with its own seed
+ * @param theme Theme to read the tiles with. The pixel average recognition is used by default
+ * @param speculate Whether the next runs are solved ahead of time
+ * @return returns true if every game ended with the state the solver saw, false otherwise
+ */
+template <typename BoardT>
+bool benchGames(std::vector<BenchResult>& results, const std::string& name, const BoardT& empty, int bombs, int games, const Theme* theme = nullptr, bool speculate = false) {
+    Screenshot screen(empty.rows(), empty.cols());
+    int clicks = 0;
+    int won = 0;
+    int lost = 0;
+    int wrong = 0;
+    int hits = 0;
+    int speculated = 0;
+    auto run = [&] {
+        clicks = 0;
+        won = 0;
+        lost = 0;
+        wrong = 0;
+        hits = 0;
+        speculated = 0;
+        for (int seed = 0; seed < games; seed++) {
+            SimulatedGame game(empty.rows(), empty.cols(), bombs, seed);
+            BoardT board = empty;
+            GAME_STATE result;
+            Speculator<BoardT> speculator;
+            clicks += playSimulated(board, game, screen, true, theme, result, speculate ? &speculator : nullptr);
+            hits += speculator.hits;
+            speculated += speculator.speculated;
+            if (game.won()) won++;
+            if (game.lost) lost++;
+            if ((result == WON) != game.won() || (result == LOST) != game.lost) wrong++;
+        }
+    };
+    BenchResult result = measure(name, run, games);
+    result.clicks_per_op = (double)clicks / games;
+    results.push_back(result);
+    fprintf(stderr, "%s: %d of %d games won, %d lost, %d unfinished\n", name.c_str(), won, games, lost, games - won - lost);
+    if (speculate) fprintf(stderr, "%s: %d of %d speculated batches had the next run ready\n", name.c_str(), hits, speculated);
+    if (wrong) fprintf(stderr, "FAILURE %s: %d games ended with the wrong state\n", name.c_str(), wrong);
+    return wrong == 0;
+}
+
+/**
+ * This function builds a board in the middle of a game, after a few solver runs
+ * @param board Board to be filled, with every tile undiscovered
+ * @param bombs Amount of bombs
+ * @param seed Game seed
+ */
+template <typename BoardT>
+void midgame(BoardT& board, int bombs, unsigned seed) {
+    SimulatedGame game(board.rows(), board.cols(), bombs, seed);
+    Screenshot screen(board.rows(), board.cols());
+    screen.draw(game);
+    parseBoard(screen.img, board, false);
+    SolverState state(board.size());
+    Planner planner;
+    for (int k = 0; k < 3; k++) {
+        solvePass(board, state);
+        for (auto &move : planMoves(board, state.arena.moves, planner)) game.perform(move);
+        screen.draw(game);
+        parseBoard(screen.img, board, false);
+    }
+}
+
+/**
+ * This function plays a game until the solver is stalled: not even pivoting decides anything
+ * @param board Board to be filled, with every tile undiscovered. It's left at the stalled position
+ * @param bombs Amount of bombs
+ * @param seed Game seed
+ * @return returns true if the game got stalled before it was over, false if not
+ */
+template <typename BoardT>
+bool stalledGame(BoardT& board, int bombs, unsigned seed) {
+    SimulatedGame game(board.rows(), board.cols(), bombs, seed);
+    Screenshot screen(board.rows(), board.cols());
+    screen.draw(game);
+    parseBoard(screen.img, board, false);
+    SolverState state(board.size());
+    state.mines = bombs;
+    Planner planner;
+    std::vector<Move> planned;
+    while (!game.lost && !game.won()) {
+        BoardT pivoted = board;
+        SolverState stalled = state;
+        stalled.board_stalled = true;
+        if (solvePass(pivoted, stalled) == 0) return true;
+        if (!planRun(board, state, planner, planned)) return false;
+        for (auto &move : planned) game.perform(move);
+        screen.draw(game);
+        parseBoard(screen.img, board, false);
+    }
+    return false;
+}
+
+/**
+ * This function checks that a game is given up when the screen never shows the tiles its moves reveal, as
+ * when every click misses
+ * @param name Check name, for the logs
+ * @return returns true if the game was given up as unfinished, false otherwise
+ */
+bool checkIdleGame(const std::string& name) {
+    BeginnerBoard board;
+    boardFromText(board, {"M1EEEEEEE", "11EEEEEEE", "EEEEEEEEE", "EEEEEEEEE", "EEEEEEEEE", "EEEEEEEEE", "EEEEEEEEE", "EEEEEEEEE", "EEEEEEEEE"});
+    SolverState state(board.size());
+    state.mines = 10;
+    Planner planner;
+    // Far more batches than a game giving up can take. Past them, the game is stopped as lost.
+    const int limit = 1000;
+    int batches = 0;
+    GAME_STATE result = solveGame(board, state, planner, [&](const std::vector<Move>& planned) {
+        // The board is left as it was, nothing shows up on screen
+        return ++batches < limit ? IN_PROGRESS : LOST;
+    });
+    if (result != IN_PROGRESS) fprintf(stderr, "FAILURE %s: the game wasn't given up after %d batches\n", name.c_str(), batches);
+    return result == IN_PROGRESS;
+}
+
+/**
+ * This function checks that a whole solver run on a board doesn't allocate any memory
+ * @param name Check name, for the logs
+ * @param position Position to be used
+ * @param stalled Whether the run is done with the PIVOT strategy, as on a stalled board
+ * @return returns true if no memory was allocated, false otherwise
+ */
+template <typename BoardT>
+bool checkAllocations(const std::string& name, const BoardT& position, bool stalled) {
+    BoardT board = position;
+    SolverState state(board.size());
+    state.board_stalled = stalled;
+    std::size_t allocations = allocation_counter;
+    solvePass(board, state);
+    std::size_t allocated = allocation_counter - allocations;
+    if (allocated) fprintf(stderr, "FAILURE %s: solvePass() allocated %d times\n", name.c_str(), (int)allocated);
+    return allocated == 0;
+}
+
+/**
+ * This function benchmarks surroundingTiles() over every tile of a board
+ * @param results List where the result is appended
+ * @param name Benchmark name
+ * @param board Board to be used
+ */
+template <typename BoardT>
+void benchSurroundings(std::vector<BenchResult>& results, const std::string& name, const BoardT& board) {
+    results.push_back(measure(name, [&] {
+        int found = 0;
+        for (int i = 0; i < board.rows(); i++) {
+            for (int j = 0; j < board.cols(); j++) found += surroundingTiles(board, i, j).size();
+        }
+        doNotOptimize(found);
+    }, board.rows()*board.cols()));
+}
+
+/**
+ * This function benchmarks markBombs() on a canned position. The board is restored before every call.
+ * @param results List where the result is appended
+ * @param name Benchmark name
+ * @param canned Position to be used
+ * @param x X coordinate of the tile
+ * @param y Y coordinate of the tile
+ * @param strategy Strategy to be used
+ */
+template <typename BoardT>
+void benchMarkBombs(std::vector<BenchResult>& results, const std::string& name, const BoardT& canned, int x, int y, STRATEGY strategy) {
+    BoardT board = canned;
+    SolveArena arena(board.size());
+    results.push_back(measure(name, [&] {
+        board = canned;
+        arena.reset();
+        doNotOptimize(markBombs(board, x, y, arena, strategy));
+    }));
+    if (arena.moves.size() == 0) fprintf(stderr, "%s: no moves were decided\n", name.c_str());
+}
+
+/**
+ * This function benchmarks a whole solver run on a board
+ * @param results List where the result is appended
+ * @param name Benchmark name
+ * @param position Position to be used
+ */
+template <typename BoardT>
+void benchSolvePass(std::vector<BenchResult>& results, const std::string& name, const BoardT& position) {
+    BoardT board = position;
+    SolverState state(board.size());
+    results.push_back(measure(name, [&] {
+        board = position;
+        std::fill(state.visited.begin(), state.visited.end(), 0);
+        doNotOptimize(solvePass(board, state));
+    }));
+}
+
+/**
+ * This function benchmarks the mine probabilities of a board, worked out from scratch and brought up to
+ * date after a single bomb is marked
+ * @param results List where the results are appended
+ * @param name Benchmark name, followed by /full and /incremental
+ * @param position Position to be used
+ * @param bombs Amount of bombs
+ */
+template <typename BoardT>
+void benchProbabilities(std::vector<BenchResult>& results, const std::string& name, const BoardT& position, int bombs) {
+    results.push_back(measure(name + "/full", [&] {
+        ProbabilityMap map;
+        map.update(position, bombs);
+        doNotOptimize(map.at(0));
+    }));
+
+    // An undiscovered tile next to a number, marked and unmarked in turns
+    int cell = -1;
+    for (int i = 0; i < position.size() && cell < 0; i++) {
+        if (position[i] != 'E') continue;
+        for (int k : position.neighbours(i)) {
+            if (isNumber(position[k])) cell = i;
+        }
+    }
+    BoardT board = position;
+    ProbabilityMap map;
+    map.update(board, bombs);
+    int enumerated = map.enumerated;
+    int updates = 0;
+    results.push_back(measure(name + "/incremental", [&] {
+        board[cell] = board[cell] == 'E' ? 'M' : 'E';
+        map.update(board, bombs);
+        updates++;
+        doNotOptimize(map.at(cell));
+    }));
+    fprintf(stderr, "%s: %d components in the board, %.1f enumerated again per update\n", name.c_str(), enumerated, (double)(map.enumerated - enumerated)/updates);
+}
+
+/**
+ * This function benchmarks the parsing of a screenshot, from a board with every tile undiscovered
+ * @param results List where the result is appended
+ * @param name Benchmark name
+ * @param empty Board with every tile undiscovered
+ * @param bombs Amount of bombs
+ * @param theme Theme to read the tiles with. The pixel average recognition is used by default
+ * @return returns true if every tile was read right, false otherwise
+ */
+template <typename BoardT>
+bool benchParse(std::vector<BenchResult>& results, const std::string& name, const BoardT& empty, int bombs, const Theme* theme = nullptr) {
+    SimulatedGame game(empty.rows(), empty.cols(), bombs, 1);
+    Screenshot screen(empty.rows(), empty.cols());
+    screen.draw(game);
+    BoardT board = empty;
+    results.push_back(measure(name, [&] {
+        board = empty;
+        parseBoard(screen.img, board, false, BoardOrigin(), theme);
+    }, empty.rows()*empty.cols()));
+
+    // The pixel average recognition can't tell 7 and 8 apart from the background, leave them out
+    int wrong = 0;
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) {
+            int number = game.around(i, j, game.bombs);
+            char expected = game.revealed[i*game.cols + j] ? (char)(48+number) : 'E';
+            if ((number < 7 || theme) && board.at(i, j) != expected) wrong++;
+        }
+    }
+    if (wrong) fprintf(stderr, "FAILURE %s: %d tiles parsed wrong\n", name.c_str(), wrong);
+    return wrong == 0;
+}
+
+/**
+ * This function learns the theme of the drawn screenshots, from an expert board with every tile state
+ * @param theme Theme to be learned
+ * @return returns the amount of tiles of that board read wrong with the theme
+ */
+int learnDrawnTheme(Theme& theme) {
+    Screenshot screen(16, 30);
+    ExpertBoard labels;
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < 30; j++) {
+            int state = (i*30 + j) % TILE_STATES;
+            screen.drawTile(i, j, state);
+            labels.at(i, j) = TILE_CHARS[state];
+        }
+    }
+    ThemeSamples samples;
+    collectSamples(screen.img, labels, BoardOrigin(), samples);
+    learnTheme(samples, theme);
+
+    ExpertBoard board;
+    parseBoard(screen.img, board, false, BoardOrigin(), &theme);
+    int wrong = 0;
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < 30; j++) {
+            if (board.at(i, j) != labels.at(i, j)) wrong++;
+        }
+    }
+    return wrong;
+}
+
+/**
+ * This function reads results saved by a previous run
+ * @param path CSV file to be read
+ * @return returns the results by benchmark name. It's empty if the file can't be read
+ */
+std::map<std::string, BenchResult> readResults(const std::string& path) {
+    std::map<std::string, BenchResult> results;
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line)) {
+        std::stringstream fields(line);
+        BenchResult result;
+        std::string value;
+        std::getline(fields, result.name, ',');
+        std::getline(fields, value, ',');
+        result.ns_per_op = atof(value.c_str());
+        std::getline(fields, value, ',');
+        result.allocs_per_op = atof(value.c_str());
+        std::getline(fields, value, ',');
+        result.clicks_per_op = atof(value.c_str());
+        results[result.name] = result;
+    }
+    return results;
+}
+
+/**
+ * That's the benchmarks main function
+ * @param argc Amount of arguments
+ * @param argv Array with arguments. All of them are optional:
+ * * --baseline FILE : compare the results with a previous run
+ * * --save FILE     : save the results
+ * * --tolerance T   : how much slower than the baseline is accepted without a warning. It's 0.25 (25%) by default
+ * * --limit L       : how much slower than the baseline is a regression. It's 1 (twice as slow) by default,
+ *                     far above the noise of the timings
+ * * --strict        : being slower than the tolerance is a regression too
+ * * --filter TEXT   : only run benchmarks with TEXT in their names
+ * @return returns 1 if there was any regression or failed check, 0 otherwise
+ */
+int main(int argc, const char* argv[]) {
+    std::string baseline_path;
+    std::string save_path;
+    std::string filter;
+    double tolerance = 0.25;
+    double limit = 1;
+    bool strict = false;
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--baseline") == 0 && arg+1 < argc) baseline_path = argv[++arg];
+        else if (strcmp(argv[arg], "--save") == 0 && arg+1 < argc) save_path = argv[++arg];
+        else if (strcmp(argv[arg], "--tolerance") == 0 && arg+1 < argc) tolerance = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "--limit") == 0 && arg+1 < argc) limit = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "--filter") == 0 && arg+1 < argc) filter = argv[++arg];
+        else if (strcmp(argv[arg], "--strict") == 0) strict = true;
+    }
+    // The solver is chatty, and printing isn't what's being measured
+    std::cout.setstate(std::ios::failbit);
+
+    std::vector<BenchResult> results;
+    auto selected = [&](const std::string& name) { return name.find(filter) != std::string::npos; };
+
+    // Micro benchmarks
+    ExpertBoard expert;
+    midgame(expert, 99, 7);
+    DynamicBoard expert_dynamic(16, 30);
+    midgame(expert_dynamic, 99, 7);
+    BeginnerBoard beginner;
+    midgame(beginner, 10, 7);
+
+    // Checks on the solver, failing the benchmarks whatever the baseline says
+    int failures = 0;
+    ExpertBoard stalled;
+    if (!stalledGame(stalled, 99, 3)) {
+        fprintf(stderr, "FAILURE allocations/stalled: the game never got stalled\n");
+        failures++;
+    }
+    if (!checkAllocations("allocations/expert", expert, false)) failures++;
+    if (!checkAllocations("allocations/expert_dynamic", expert_dynamic, false)) failures++;
+    if (!checkAllocations("allocations/stalled", stalled, true)) failures++;
+    if (!checkIdleGame("games/idle")) failures++;
+
+    if (selected("surroundingTiles/beginner")) benchSurroundings(results, "surroundingTiles/beginner", beginner);
+    if (selected("surroundingTiles/expert")) benchSurroundings(results, "surroundingTiles/expert", expert);
+    if (selected("surroundingTiles/expert_dynamic")) benchSurroundings(results, "surroundingTiles/expert_dynamic", expert_dynamic);
+
+    if (selected("colorIdentifier")) {
+        const Vec4b colors[] = {Vec4b(192, 192, 192, 255), Vec4b(255, 0, 0, 255), Vec4b(0, 128, 0, 255), Vec4b(0, 0, 255, 255),
+                                Vec4b(128, 0, 0, 255), Vec4b(0, 0, 128, 255), Vec4b(128, 128, 0, 255), Vec4b(0, 0, 0, 255),
+                                Vec4b(255, 255, 255, 255), Vec4b(100, 150, 200, 255)};
+        results.push_back(measure("colorIdentifier", [&] {
+            int sum = 0;
+            for (auto &color : colors) sum += colorIdentifier(color);
+            doNotOptimize(sum);
+        }, 10));
+    }
+
+    if (selected("pixelAverage")) {
+        SimulatedGame game(16, 30, 99, 1);
+        Screenshot screen(16, 30);
+        screen.draw(game);
+        results.push_back(measure("pixelAverage/depth0", [&] { doNotOptimize(pixelAverage(screen.img, 300, 343, 0)); }));
+        results.push_back(measure("pixelAverage/depth3", [&] { doNotOptimize(pixelAverage(screen.img, 300, 343)); }));
+    }
+
+    if (selected("markBombs")) {
+        BeginnerBoard canned;
+        boardFromText(canned, {"1M0000000", "EE0000000", "000000000", "000000000", "000000000", "000000000", "000000000", "000000000", "000000000"});
+        benchMarkBombs(results, "markBombs/simple_reveal", canned, 0, 0, SIMPLE);
+        boardFromText(canned, {"2E0000000", "E00000000", "000000000", "000000000", "000000000", "000000000", "000000000", "000000000", "000000000"});
+        benchMarkBombs(results, "markBombs/simple_mark", canned, 0, 0, SIMPLE);
+        // Both examples from pivotBoard()
+        boardFromText(canned, {"000000000", "212100000", "EEEE00000", "000000000", "000000000", "000000000", "000000000", "000000000", "000000000"});
+        benchMarkBombs(results, "pivotBoard/mark", canned, 1, 1, PIVOT);
+        boardFromText(canned, {"002E00000", "123M00000", "1EEE00000", "000000000", "000000000", "000000000", "000000000", "000000000", "000000000"});
+        benchMarkBombs(results, "pivotBoard/reveal", canned, 1, 2, PIVOT);
+    }
+
+    if (selected("solvePass/expert")) benchSolvePass(results, "solvePass/expert", expert);
+    if (selected("solvePass/expert_dynamic")) benchSolvePass(results, "solvePass/expert_dynamic", expert_dynamic);
+    if (selected("probabilityMap/expert")) benchProbabilities(results, "probabilityMap/expert", expert, 99);
+
+    if (selected("parseBoard/beginner")) failures += !benchParse(results, "parseBoard/beginner", BeginnerBoard(), 10);
+    if (selected("parseBoard/expert")) failures += !benchParse(results, "parseBoard/expert", ExpertBoard(), 99);
+
+    Theme theme;
+    if (int wrong = learnDrawnTheme(theme)) {
+        fprintf(stderr, "FAILURE theme: %d of 480 tiles read wrong\n", wrong);
+        failures++;
+    }
+    if (selected("parseBoard/beginner_glyph")) failures += !benchParse(results, "parseBoard/beginner_glyph", BeginnerBoard(), 10, &theme);
+    if (selected("parseBoard/expert_glyph")) failures += !benchParse(results, "parseBoard/expert_glyph", ExpertBoard(), 99, &theme);
+
+    if (selected("locateBoards")) {
+        // Three games on one screen, one of them already started
+        Screenshot screen(9, 9, 3);
+        SimulatedGame started(9, 9, 10, 1);
+        SimulatedGame fresh(9, 9, 10, 2);
+        std::fill(fresh.revealed.begin(), fresh.revealed.end(), 0);
+        screen.draw(fresh, 0);
+        screen.draw(started, 1);
+        screen.draw(fresh, 2);
+        std::vector<BoardOrigin> found;
+        results.push_back(measure("locateBoards/beginner_x3", [&] { found = locateBoards(screen.img, 9, 9); }));
+        if (found.size() != 2 || found[0].x != screen.origin(0).x || found[1].x != screen.origin(2).x) {
+            fprintf(stderr, "FAILURE locateBoards/beginner_x3: %d boards found, 2 expected\n", (int)found.size());
+            failures++;
+        }
+
+        // The started game is read at its own origin
+        BeginnerBoard board;
+        parseBoard(screen.img, board, false, screen.origin(1));
+        int wrong = 0;
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                int number = started.around(i, j, started.bombs);
+                char expected = started.revealed[i*9 + j] ? (char)(48+number) : 'E';
+                if (number < 7 && board.at(i, j) != expected) wrong++;
+            }
+        }
+        if (wrong) {
+            fprintf(stderr, "FAILURE locateBoards/beginner_x3: %d tiles parsed wrong at the board's origin\n", wrong);
+            failures++;
+        }
+    }
+
+    // Macro benchmarks
+    if (selected("game/beginner")) failures += !benchGames(results, "game/beginner", BeginnerBoard(), 10, 50);
+    if (selected("game/intermediate")) failures += !benchGames(results, "game/intermediate", IntermediateBoard(), 40, 20);
+    if (selected("game/expert")) failures += !benchGames(results, "game/expert", ExpertBoard(), 99, 10);
+    if (selected("game/expert_glyph")) failures += !benchGames(results, "game/expert_glyph", ExpertBoard(), 99, 10, &theme);
+    if (selected("game/expert_speculate")) failures += !benchGames(results, "game/expert_speculate", ExpertBoard(), 99, 10, nullptr, true);
+
+    printf("name,ns_per_op,allocs_per_op,clicks_per_op\n");
+    for (auto &result : results) {
+        printf("%s,%.2f,%.2f,%.2f\n", result.name.c_str(), result.ns_per_op, result.allocs_per_op, result.clicks_per_op);
+    }
+
+    if (save_path.size() > 0) {
+        FILE* file = fopen(save_path.c_str(), "w");
+        if (file == NULL) {
+            fprintf(stderr, "Couldn't write %s\n", save_path.c_str());
+            return 1;
+        }
+        fprintf(file, "name,ns_per_op,allocs_per_op,clicks_per_op\n");
+        for (auto &result : results) {
+            fprintf(file, "%s,%.2f,%.2f,%.2f\n", result.name.c_str(), result.ns_per_op, result.allocs_per_op, result.clicks_per_op);
+        }
+        fclose(file);
+    }
+
+    if (failures) fprintf(stderr, "%d checks failed\n", failures);
+    if (baseline_path.size() == 0) return failures ? 1 : 0;
+    std::map<std::string, BenchResult> baseline = readResults(baseline_path);
+    if (baseline.size() == 0) {
+        fprintf(stderr, "FAILURE no baseline found at %s, run \"make bench-baseline\" to create one\n", baseline_path.c_str());
+        return 1;
+    }
+    int regressions = 0;
+    int slower = 0;
+    for (auto &result : results) {
+        if (baseline.count(result.name) == 0) continue;
+        BenchResult& before = baseline[result.name];
+        if (result.ns_per_op > before.ns_per_op*(1+tolerance)) {
+            bool regression = strict || result.ns_per_op > before.ns_per_op*(1+limit);
+            fprintf(stderr, "%s %s: %.2f ns/op, baseline %.2f ns/op (%+.0f%%)\n", regression ? "REGRESSION" : "SLOWER", result.name.c_str(), result.ns_per_op, before.ns_per_op, 100*(result.ns_per_op/before.ns_per_op-1));
+            if (regression) regressions++;
+            else slower++;
+        }
+        if (result.allocs_per_op > before.allocs_per_op) {
+            fprintf(stderr, "REGRESSION %s: %.2f allocations/op, baseline %.2f\n", result.name.c_str(), result.allocs_per_op, before.allocs_per_op);
+            regressions++;
+        }
+        if (result.clicks_per_op > before.clicks_per_op) {
+            fprintf(stderr, "REGRESSION %s: %.2f clicks/op, baseline %.2f\n", result.name.c_str(), result.clicks_per_op, before.clicks_per_op);
+            regressions++;
+        }
+    }
+    if (regressions) {
+        fprintf(stderr, "%d regressions against %s\n", regressions, baseline_path.c_str());
+        return 1;
+    }
+    if (slower) fprintf(stderr, "%d benchmarks between %.0f%% and %.0f%% slower than %s, which only fails with --strict\n", slower, 100*tolerance, 100*limit, baseline_path.c_str());
+    fprintf(stderr, "No regressions against %s\n", baseline_path.c_str());
+    return failures ? 1 : 0;
+}
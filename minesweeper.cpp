@@ -7,6 +7,21 @@
  */ 
 
 #include <vector>
+#include <array>
+#include <utility>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <new>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <X11/Xlib.h>
@@ -19,6 +34,40 @@
 // Namespaces
 using namespace cv;
 
+#ifdef COUNT_ALLOCATIONS
+// When built with -DCOUNT_ALLOCATIONS, every heap allocation goes through here and gets counted, so the
+// allocations done by a piece of code can be checked.
+std::atomic<std::size_t> allocation_counter(0);
+
+// The replacements are kept out of line. Once inlined, GCC sees memory from operator new being given to
+// free(), and warns about it with -Wmismatched-new-delete.
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    allocation_counter++;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
 // Enums
 // Colors
 enum COLOR {
@@ -37,28 +86,712 @@ enum COLOR {
 // Actions during working with bombs and freeing tiles
 enum ACTION {
     REVEAL_TILE=Button1,
-    MARK_BOMB=Button3
+    MARK_BOMB=Button3,
+    // Left click on a numbered tile with all its bombs marked, revealing every other tile around it
+    CHORD_TILE
 };
 // Which strategy to use before choosing an action
 enum STRATEGY {
     SIMPLE=0,
     PIVOT=1
 };
+// Tile states told apart by the glyph recognizer. Numbers from 1 to 8 keep their own value.
+enum TILE_STATE {
+    TILE_BLANK=0,
+    TILE_UNDISCOVERED=9,
+    TILE_FLAG=10,
+    TILE_MINE=11,
+    TILE_EXPLODED=12,
+    TILE_STATES=13
+};
+// How a game is going
+enum GAME_STATE {
+    IN_PROGRESS=0,
+    WON=1,
+    LOST=2
+};
 // Board difficulty
 enum DIFFICULTY {
     BEGINNER=0,
     INTERMEDIATE=1,
-    EXPERT=2
+    EXPERT=2,
+    CUSTOM=3
+};
+
+// Where the solver logs its decisions. Speculative runs log into their own buffer, printed only once the run
+// is taken, so only moves actually made are logged.
+thread_local std::ostream* solver_log = &std::cout;
+
+// A single click decided by the solver. x and y are board coordinates (row and column), the conversion
+// to screen pixels only happens when the move is executed.
+struct Move {
+    int x;
+    int y;
+    ACTION action;
+};
+
+// Where a board is on the screen. The pixel offsets in this file were measured on a board at the (0, 0)
+// origin, every other board is read and clicked shifted by its origin.
+struct BoardOrigin {
+    int x = 0;
+    int y = 0;
+};
+
+// Fixed-capacity list of tiles, stored inline as packed indices (x*cols + y), so building one never allocates.
+template <int Capacity>
+struct TileList {
+    short cells[Capacity] = {};
+    int count = 0;
+
+    constexpr void push(int cell) { cells[count++] = cell; }
+    constexpr int size() const { return count; }
+    constexpr const short* begin() const { return cells; }
+    constexpr const short* end() const { return cells + count; }
+};
+// A tile has at most 8 tiles around it
+typedef TileList<8> NeighbourList;
+
+/**
+ * Board with its size only known at run time, used for custom sizes. Tiles are stored row by row in a
+ * single array, so every tile can also be addressed by its packed index (x*cols + y). The tiles around
+ * each tile are computed only once, when the board is created.
+ */
+class DynamicBoard {
+public:
+    DynamicBoard(int rows = 0, int cols = 0, char tile = 'E') : n_rows(rows), n_cols(cols), tiles(rows*cols, tile), neighbour_table(rows*cols) {
+        for (int x = 0; x < rows; x++) {
+            for (int y = 0; y < cols; y++) {
+                for (int i = std::max(x-1, 0); i <= std::min(x+1, rows-1); i++) {
+                    for (int j = std::max(y-1, 0); j <= std::min(y+1, cols-1); j++) {
+                        if (i != x || j != y) neighbour_table[index(x, y)].push(index(i, j));
+                    }
+                }
+            }
+        }
+    }
+
+    int rows() const { return n_rows; }
+    int cols() const { return n_cols; }
+    // Amount of packed indices
+    int size() const { return n_rows*n_cols; }
+    int index(int x, int y) const { return x*n_cols + y; }
+    int row(int cell) const { return cell / n_cols; }
+    int col(int cell) const { return cell % n_cols; }
+
+    char& at(int x, int y) { return tiles[index(x, y)]; }
+    char at(int x, int y) const { return tiles[index(x, y)]; }
+    char& operator[](int cell) { return tiles[cell]; }
+    char operator[](int cell) const { return tiles[cell]; }
+
+    // Tiles around the given one, in row-major order
+    const NeighbourList& neighbours(int cell) const { return neighbour_table[cell]; }
+
+    template <typename F>
+    void forEachNeighbour(int cell, F&& visit) const {
+        for (int i : neighbour_table[cell]) visit(i);
+    }
+
+private:
+    int n_rows;
+    int n_cols;
+    std::vector<char> tiles;
+    std::vector<NeighbourList> neighbour_table;
+};
+
+/**
+ * Board with its size known at compile time, used for the standard difficulties. Tiles are stored row by
+ * row with a border of padding tiles ('#') around them, so the tiles around any tile are always at the same
+ * 8 offsets and can be visited without edge checks. Packed indices point into this padded storage, and the
+ * neighbor tables are all built by the compiler.
+ */
+template <int Rows, int Cols>
+class StaticBoard {
+public:
+    // Distance between a tile and the one right below it
+    static constexpr int Stride = Cols+2;
+    static constexpr int Slots = (Rows+2)*Stride;
+
+    StaticBoard(char tile = 'E') {
+        tiles.fill('#');
+        for (int x = 0; x < Rows; x++) {
+            for (int y = 0; y < Cols; y++) tiles[index(x, y)] = tile;
+        }
+    }
+
+    static constexpr int rows() { return Rows; }
+    static constexpr int cols() { return Cols; }
+    // Amount of packed indices, padding included
+    static constexpr int size() { return Slots; }
+    static constexpr int index(int x, int y) { return (x+1)*Stride + y+1; }
+    static constexpr int row(int cell) { return cell/Stride - 1; }
+    static constexpr int col(int cell) { return cell%Stride - 1; }
+
+    char& at(int x, int y) { return tiles[index(x, y)]; }
+    char at(int x, int y) const { return tiles[index(x, y)]; }
+    char& operator[](int cell) { return tiles[cell]; }
+    char operator[](int cell) const { return tiles[cell]; }
+
+    // Tiles around the given one, in row-major order
+    const NeighbourList& neighbours(int cell) const { return neighbour_table[cell]; }
+
+    /**
+     * Visits the 8 slots around a tile, fully unrolled. Slots outside the board are padding, holding '#'.
+     */
+    template <typename F>
+    void forEachNeighbour(int cell, F&& visit) const {
+        visitOffsets(cell, visit, std::make_index_sequence<8>());
+    }
+
+private:
+    // Offsets of the tiles around a given one, in row-major order
+    static constexpr int offsets[8] = {-Stride-1, -Stride, -Stride+1, -1, 1, Stride-1, Stride, Stride+1};
+
+    template <typename F, std::size_t... K>
+    static void visitOffsets(int cell, F& visit, std::index_sequence<K...>) {
+        (visit(cell + offsets[K]), ...);
+    }
+
+    // Bit k is set when the k-th tile around a tile is inside the board
+    static constexpr std::array<unsigned char, Slots> buildEdgeMasks() {
+        std::array<unsigned char, Slots> masks = {};
+        for (int x = 0; x < Rows; x++) {
+            for (int y = 0; y < Cols; y++) {
+                for (int k = 0; k < 8; k++) {
+                    int neighbour = index(x, y) + offsets[k];
+                    if (row(neighbour) >= 0 && row(neighbour) < Rows && col(neighbour) >= 0 && col(neighbour) < Cols) {
+                        masks[index(x, y)] |= 1 << k;
+                    }
+                }
+            }
+        }
+        return masks;
+    }
+
+    static constexpr std::array<NeighbourList, Slots> buildNeighbourTable() {
+        std::array<NeighbourList, Slots> table = {};
+        for (int cell = 0; cell < Slots; cell++) {
+            for (int k = 0; k < 8; k++) {
+                if (edge_masks[cell] >> k & 1) table[cell].push(cell + offsets[k]);
+            }
+        }
+        return table;
+    }
+
+    static constexpr std::array<unsigned char, Slots> edge_masks = buildEdgeMasks();
+    static constexpr std::array<NeighbourList, Slots> neighbour_table = buildNeighbourTable();
+
+    std::array<char, Slots> tiles;
+};
+
+// Boards for the standard difficulties
+typedef StaticBoard<9, 9> BeginnerBoard;
+typedef StaticBoard<16, 16> IntermediateBoard;
+typedef StaticBoard<16, 30> ExpertBoard;
+
+/**
+ * Scratch memory for a single board run. It's sized once for the board and reset before every run, so the
+ * run itself never allocates. Every tile gets at most one move per run, no matter how many numbered tiles
+ * lead to it.
+ */
+struct SolveArena {
+    // Moves decided in the current run
+    std::vector<Move> moves;
+    // Tiles which already have a move in the current run
+    std::vector<char> decided;
+
+    explicit SolveArena(int size = 0) : decided(size, 0) { moves.reserve(size); }
+
+    void reset() {
+        moves.clear();
+        std::fill(decided.begin(), decided.end(), 0);
+    }
+
+    void push(int cell, const Move& move) {
+        if (decided[cell]) return;
+        decided[cell] = 1;
+        moves.push_back(move);
+    }
+};
+
+/**
+ * Mine probability of every undiscovered tile, kept between board runs. The undiscovered tiles next to
+ * numbers are split in frontier components, tiles tied together by the numbers around them. Every
+ * component keeps its own solution counts, by amount of bombs, and an update only enumerates again the
+ * components around tiles changed since the last one. Weighing the components against each other, and
+ * against the bombs left for the tiles away from the numbers, is cheap and redone on every update.
+ * Between updates, the probability of any tile is read in O(1).
+ */
+class ProbabilityMap {
+public:
+    // Largest amount of steps spent enumerating a single component. Past it, the component is estimated
+    // from its numbers alone, so even a stalled expert board is resolved in bounded time.
+    static constexpr long MAX_STEPS = 200000;
+    // Components enumerated since the map was created
+    int enumerated = 0;
+
+    /**
+     * Brings the map up to date with the board. Only the components within two tiles of a changed tile
+     * are enumerated again.
+     * @param board Board as the solver knows it, bombs marked included
+     * @param mines Amount of bombs in the game. When it's 0, the components aren't weighed by it.
+     */
+    template <typename BoardT>
+    void update(const BoardT& board, int mines) {
+        if ((int)seen.size() != board.size()) {
+            seen.assign(board.size(), 0);
+            component.assign(board.size(), -1);
+            probability.assign(board.size(), 0);
+            touched.assign(board.size(), 0);
+            local.assign(board.size(), -1);
+            components.clear();
+            free_slots.clear();
+        }
+
+        // A changed tile changes the numbers around it, and those tie every tile around them
+        seeds.clear();
+        for (int cell = 0; cell < board.size(); cell++) {
+            if (board[cell] == seen[cell]) continue;
+            seen[cell] = board[cell];
+            touch(cell);
+            for (int i : board.neighbours(cell)) {
+                touch(i);
+                for (int k : board.neighbours(i)) touch(k);
+            }
+        }
+        for (int cell : seeds) touched[cell] = 0;
+
+        // The tiles left without a component are grouped again
+        for (std::size_t s = 0; s < seeds.size(); s++) {
+            int cell = seeds[s];
+            if (component[cell] < 0 && frontier(board, cell)) build(board, cell);
+        }
+        weigh(board, mines);
+    }
+
+    /**
+     * Mine probability of an undiscovered tile, as of the last update
+     * @param cell Packed index of the tile
+     * @return returns the probability, from 0 to 1
+     */
+    double at(int cell) const { return component[cell] >= 0 ? probability[cell] : interior; }
+
+    /**
+     * Tells if a probability of 0 or 1 is a certainty. Tiles away from the numbers are only known for sure
+     * when the amount of bombs is.
+     * @param cell Packed index of the tile
+     * @return returns true if the tile is certainly free when at() is 0, and certainly a bomb when it's 1
+     */
+    bool sure(int cell) const { return component[cell] >= 0 || weighed; }
+
+private:
+    // Undiscovered tiles tied together by the numbers around them
+    struct Component {
+        std::vector<int> cells;
+        // Share of the solutions with every amount of bombs, and the same for every tile being a bomb,
+        // indexed by tile*(cells+1) + bombs
+        std::vector<double> counts;
+        std::vector<double> cell_counts;
+        // False when the enumeration took too long, and the probabilities come from the numbers alone
+        bool exact = true;
+        bool alive = false;
+    };
+
+    // A number around a component, and how its bombs are placed during the enumeration
+    struct Constraint {
+        int need = 0;
+        int open = 0;
+        int bombs = 0;
+        NeighbourList cells;
+    };
+
+    // Board as of the last update
+    std::vector<char> seen;
+    // Component of every frontier tile, or -1
+    std::vector<int> component;
+    std::vector<double> probability;
+    // Probability of every undiscovered tile away from the numbers
+    double interior = 0;
+    // Whether the amount of bombs was used to weigh the components
+    bool weighed = false;
+    std::vector<Component> components;
+    std::vector<int> free_slots;
+
+    // Scratch memory of the updates, kept so an update only allocates for the components enumerated again
+    std::vector<int> seeds;
+    std::vector<char> touched;
+    std::vector<int> local;
+    std::vector<Constraint> constraints;
+    std::vector<NeighbourList> cell_constraints;
+    std::vector<char> assigned;
+    long steps = 0;
+    std::vector<int> alive;
+    std::vector<std::vector<double>> before;
+    std::vector<std::vector<double>> after;
+    std::vector<double> rest;
+    std::vector<double> others;
+    std::vector<double> weights;
+
+    static bool isConstraint(char tile) { return tile >= '0' && tile <= '8'; }
+
+    template <typename BoardT>
+    static bool frontier(const BoardT& board, int cell) {
+        if (board[cell] != 'E') return false;
+        for (int i : board.neighbours(cell)) {
+            if (isConstraint(board[i])) return true;
+        }
+        return false;
+    }
+
+    void touch(int cell) {
+        if (touched[cell]) return;
+        touched[cell] = 1;
+        seeds.push_back(cell);
+        if (component[cell] >= 0) drop(component[cell]);
+    }
+
+    // Forgets a component, leaving its tiles to be grouped again
+    void drop(int slot) {
+        for (int cell : components[slot].cells) {
+            component[cell] = -1;
+            seeds.push_back(cell);
+        }
+        components[slot].alive = false;
+        free_slots.push_back(slot);
+    }
+
+    /**
+     * Groups every frontier tile tied to the given one in a new component, and enumerates it
+     * @param board Board being mapped
+     * @param first Frontier tile without a component
+     */
+    template <typename BoardT>
+    void build(const BoardT& board, int first) {
+        int slot;
+        if (free_slots.size() > 0) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            slot = components.size();
+            components.emplace_back();
+        }
+        std::vector<int>& cells = components[slot].cells;
+        cells.assign(1, first);
+        component[first] = slot;
+        for (std::size_t k = 0; k < cells.size(); k++) {
+            for (int number : board.neighbours(cells[k])) {
+                if (!isConstraint(board[number])) continue;
+                for (int i : board.neighbours(number)) {
+                    if (board[i] != 'E' || component[i] == slot) continue;
+                    if (component[i] >= 0) drop(component[i]);
+                    component[i] = slot;
+                    cells.push_back(i);
+                }
+            }
+        }
+        components[slot].alive = true;
+        enumerate(board, components[slot]);
+    }
+
+    /**
+     * Counts every placement of bombs in a component that agrees with the numbers around it
+     * @param board Board being mapped
+     * @param comp Component to be enumerated
+     */
+    template <typename BoardT>
+    void enumerate(const BoardT& board, Component& comp) {
+        int n = comp.cells.size();
+        for (int k = 0; k < n; k++) local[comp.cells[k]] = k;
+
+        // Every number around the component, with the bombs still missing around it
+        constraints.clear();
+        cell_constraints.assign(n, NeighbourList());
+        for (int k = 0; k < n; k++) {
+            for (int number : board.neighbours(comp.cells[k])) {
+                if (!isConstraint(board[number]) || touched[number]) continue;
+                touched[number] = 1;
+                Constraint constraint;
+                constraint.need = board[number]-48;
+                for (int i : board.neighbours(number)) {
+                    if (board[i] == 'M') constraint.need--;
+                    else if (board[i] == 'E') constraint.cells.push(local[i]);
+                }
+                constraint.open = constraint.cells.size();
+                for (int i : constraint.cells) cell_constraints[i].push(constraints.size());
+                constraints.push_back(constraint);
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            for (int number : board.neighbours(comp.cells[k])) touched[number] = 0;
+        }
+
+        comp.counts.assign(n+1, 0);
+        comp.cell_counts.assign(n*(n+1), 0);
+        assigned.assign(n, 0);
+        steps = 0;
+        bool finished = search(comp, 0, 0);
+        double total = 0;
+        for (double count : comp.counts) total += count;
+        enumerated++;
+
+        comp.exact = finished && total > 0;
+        if (comp.exact) {
+            for (double& count : comp.counts) count /= total;
+            for (double& count : comp.cell_counts) count /= total;
+        } else {
+            // Too many placements, or none at all (a misread number). Every tile gets the highest share of
+            // bombs missing among the numbers around it.
+            *solver_log << "Estimating a component of " << n << " tiles from its numbers" << std::endl;
+            double bombs = 0;
+            for (int k = 0; k < n; k++) {
+                double p = 0;
+                for (int c : cell_constraints[k]) {
+                    const Constraint& constraint = constraints[c];
+                    p = std::max(p, std::min(std::max(constraint.need, 0), constraint.cells.size())/(double)constraint.cells.size());
+                }
+                probability[comp.cells[k]] = p;
+                bombs += p;
+            }
+            std::fill(comp.counts.begin(), comp.counts.end(), 0);
+            comp.counts[std::min((int)(bombs+0.5), n)] = 1;
+        }
+        for (int cell : comp.cells) local[cell] = -1;
+    }
+
+    /**
+     * Places a bomb, or not, on the k-th tile of the component and goes on with the next one
+     * @param comp Component being enumerated
+     * @param k Tile to be placed
+     * @param bombs Bombs placed so far
+     * @return returns false if the enumeration took too long, true if not
+     */
+    bool search(Component& comp, int k, int bombs) {
+        if (++steps > MAX_STEPS) return false;
+        int n = comp.cells.size();
+        if (k == n) {
+            comp.counts[bombs] += 1;
+            for (int i = 0; i < n; i++) {
+                if (assigned[i]) comp.cell_counts[i*(n+1) + bombs] += 1;
+            }
+            return true;
+        }
+        for (int bomb = 0; bomb <= 1; bomb++) {
+            bool fits = true;
+            for (int c : cell_constraints[k]) {
+                Constraint& constraint = constraints[c];
+                constraint.open--;
+                constraint.bombs += bomb;
+                if (constraint.bombs > constraint.need || constraint.bombs + constraint.open < constraint.need) fits = false;
+            }
+            assigned[k] = bomb;
+            bool finished = !fits || search(comp, k+1, bombs+bomb);
+            for (int c : cell_constraints[k]) {
+                constraints[c].open++;
+                constraints[c].bombs -= bomb;
+            }
+            if (!finished) return false;
+        }
+        assigned[k] = 0;
+        return true;
+    }
+
+    // Logarithm of the amount of ways to pick k out of n
+    static double logChoose(int n, int k) { return std::lgamma(n+1.0) - std::lgamma(k+1.0) - std::lgamma(n-k+1.0); }
+
+    // Distribution of the sum of two amounts of bombs
+    static void convolve(const std::vector<double>& a, const std::vector<double>& b, std::vector<double>& sum) {
+        sum.assign(a.size() + b.size() - 1, 0);
+        for (std::size_t i = 0; i < a.size(); i++) {
+            if (a[i] == 0) continue;
+            for (std::size_t j = 0; j < b.size(); j++) sum[i+j] += a[i]*b[j];
+        }
+    }
+
+    /**
+     * Weighs every component by the ways the bombs left fit on the rest of the board, and works out the
+     * probability of every frontier tile and of the tiles away from the numbers
+     * @param board Board being mapped
+     * @param mines Amount of bombs in the game, or 0 when it isn't known
+     */
+    template <typename BoardT>
+    void weigh(const BoardT& board, int mines) {
+        alive.clear();
+        for (int slot = 0; slot < (int)components.size(); slot++) {
+            if (components[slot].alive) alive.push_back(slot);
+        }
+        int marked = 0;
+        int unknown = 0;
+        for (int cell = 0; cell < board.size(); cell++) {
+            if (board[cell] == 'M') marked++;
+            else if (board[cell] == 'E' && component[cell] < 0) unknown++;
+        }
+        int left = mines - marked;
+
+        // Bombs in the components before and after every one of them
+        int amount = alive.size();
+        if ((int)before.size() < amount+1) {
+            before.resize(amount+1);
+            after.resize(amount+1);
+        }
+        before[0].assign(1, 1);
+        after[amount].assign(1, 1);
+        for (int c = 0; c < amount; c++) convolve(before[c], components[alive[c]].counts, before[c+1]);
+        for (int c = amount-1; c >= 0; c--) convolve(after[c+1], components[alive[c]].counts, after[c]);
+        const std::vector<double>& all = before[amount];
+
+        // Ways to place the bombs left on the tiles away from the numbers, scaled down by the largest one
+        rest.assign(all.size(), 1);
+        weighed = mines > 0;
+        if (weighed) {
+            double largest = -1;
+            for (int s = 0; s < (int)all.size(); s++) {
+                if (left-s >= 0 && left-s <= unknown) largest = std::max(largest, logChoose(unknown, left-s));
+            }
+            double total = 0;
+            for (int s = 0; s < (int)all.size(); s++) {
+                rest[s] = left-s >= 0 && left-s <= unknown ? std::exp(logChoose(unknown, left-s) - largest) : 0;
+                total += all[s]*rest[s];
+            }
+            // The amount of bombs doesn't fit the board, probably a misread. Every placement counts the same then.
+            if (total <= 0) {
+                weighed = false;
+                std::fill(rest.begin(), rest.end(), 1);
+            }
+        }
+
+        double frontier_sum = 0;
+        int frontier_tiles = 0;
+        for (int c = 0; c < amount; c++) {
+            Component& comp = components[alive[c]];
+            int n = comp.cells.size();
+            convolve(before[c], after[c+1], others);
+            weights.assign(n+1, 0);
+            double total = 0;
+            for (int m = 0; m <= n; m++) {
+                for (int s = 0; s < (int)others.size(); s++) weights[m] += others[s]*rest[m+s];
+                total += comp.counts[m]*weights[m];
+            }
+            if (total <= 0) {
+                std::fill(weights.begin(), weights.end(), 1);
+                total = 1;
+            }
+            for (int k = 0; k < n; k++) {
+                if (comp.exact) {
+                    double share = 0;
+                    for (int m = 0; m <= n; m++) share += comp.cell_counts[k*(n+1) + m]*weights[m];
+                    probability[comp.cells[k]] = share/total;
+                }
+                frontier_sum += probability[comp.cells[k]];
+                frontier_tiles++;
+            }
+        }
+
+        if (weighed && unknown > 0) {
+            double total = 0;
+            double bombs = 0;
+            for (int s = 0; s < (int)all.size(); s++) {
+                total += all[s]*rest[s];
+                bombs += all[s]*rest[s]*(left-s);
+            }
+            interior = bombs/total/unknown;
+        } else {
+            // Without the amount of bombs, they're taken as likely as on an average frontier tile
+            interior = frontier_tiles > 0 ? frontier_sum/frontier_tiles : 0.5;
+        }
+    }
+};
+
+// Everything the solver remembers between board runs.
+struct SolverState {
+    // Tiles which there's nothing else to do with them
+    std::vector<char> visited;
+    // Tiles where pivoting already failed since the last successful pivot
+    std::vector<char> pivots_visited;
+    // Set when an entire board run with the SIMPLE strategy changed nothing
+    bool board_stalled = false;
+    // Amount of bombs in the game, used to weigh guesses. It's 0 when it isn't known.
+    int mines = 0;
+    SolveArena arena;
+    ProbabilityMap probabilities;
+
+    explicit SolverState(int size = 0) : visited(size, 0), pivots_visited(size, 0), arena(size) {}
+};
+
+/**
+ * Bounded queue used to hand work from one pipeline stage to the next. Each queue has exactly one
+ * producer and one consumer thread. Pushing blocks while the queue is full, so a fast stage can't
+ * run away from a slow one, and popping blocks while it's empty. Closing the queue wakes both sides up.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    /**
+     * Pushes an item, waiting for free space if needed.
+     * @param item Item to be pushed
+     * @return returns false if the queue was closed, true otherwise
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * Pops the oldest item, waiting for one if the queue is empty.
+     * @param item Where the popped item is stored
+     * @return returns false if the queue was closed and there's nothing left in it, true otherwise
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * Drops every pending item.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.clear();
+        not_full.notify_all();
+    }
+
+    /**
+     * Closes the queue. Pending items can still be popped, but nothing else can be pushed.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
 };
 
 /**
  * This function prints the current board to the screen
  * @param board Board to be used for printing
  */
-void printBoard(std::vector<std::vector<char>>& board) {
-    for (auto i : board) {
-        for (auto j : i) {
-            std::cout << j << " ";
+template <typename BoardT>
+void printBoard(BoardT& board) {
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) {
+            std::cout << board.at(i, j) << " ";
         }
         std::cout << std::endl;
     }
@@ -70,11 +803,12 @@ void printBoard(std::vector<std::vector<char>>& board) {
  * @param Width width from the image to be stored
  * @param Height height from the image to be stored
  * @param BitsPerPixel bits per pixel to be used
+ * @param shared Connection to the X server to be used. A new one is opened when it's nullptr (default)
  */
-void ImageFromDisplay(std::vector<uint8_t>& Pixels, int& Width, int& Height, int& BitsPerPixel)
+void ImageFromDisplay(std::vector<uint8_t>& Pixels, int& Width, int& Height, int& BitsPerPixel, Display* shared = nullptr)
 {
     // Setting is as nullptr means that the env var DISPLAY value will be used (likely to be ":0")
-    Display* display = XOpenDisplay(nullptr);
+    Display* display = shared ? shared : XOpenDisplay(nullptr);
     Window root = DefaultRootWindow(display);
 
     XWindowAttributes attributes = {0};
@@ -90,16 +824,17 @@ void ImageFromDisplay(std::vector<uint8_t>& Pixels, int& Width, int& Height, int
     memcpy(&Pixels[0], img->data, Pixels.size());
 
     XDestroyImage(img);
-    XCloseDisplay(display);
+    if (!shared) XCloseDisplay(display);
 }
 
 /**
  * This function mocks a mouse click given a button and a mask.
  * @param button Which mouse button to be used
  * @param mask Which mask to be used to avoid unintended clicks/commands
+ * @param shared Connection to the X server to be used. A new one is opened when it's nullptr (default)
  */ 
-void mouseClick(int button, int mask) {
-    Display *display = XOpenDisplay(NULL);
+void mouseClick(int button, int mask, Display* shared = nullptr) {
+    Display *display = shared ? shared : XOpenDisplay(NULL);
 
     XEvent event;
 
@@ -140,7 +875,7 @@ void mouseClick(int button, int mask) {
 
     XFlush(display);
 
-    XCloseDisplay(display);
+    if (!shared) XCloseDisplay(display);
 }
 
 /**
@@ -196,174 +931,816 @@ Vec4b pixelAverage(Mat img, int x, int y, int offsetDepth = 3) {
 }
 
 /**
- * This function returns a vector containing the surrouding tiles from a given position
- * that matches with the list provided.
+ * This function returns the surrouding tiles from a given position that matches with the list provided.
  * @param board Board to be used
  * @param x X position for search the surrounding tiles
  * @param y Y position for search the surrounding tiles
- * @param searchList list of chars to be used as "valid tiles". The list is "E" and "M" by default.
- * @return returns the vector containing the surrounding tiles that matches with searchList contents
+ * @param searchList chars to be used as "valid tiles". The list is "E" and "M" by default.
+ * @return returns the list containing the surrounding tiles that matches with searchList contents
  */ 
-std::vector<std::vector<int>> surroundingTiles(std::vector<std::vector<char>>& board, int x, int y, std::vector<char> searchList = {'E', 'M'}) {
-    std::vector<std::vector<int>> result = {};
-    // Iterate through the surroundings from x,y position
-    short int board_size_x = board.size();
-    short int board_size_y = board[0].size();
-    for (int i = 0; i < 9; i++) {
-        short int pos_x = x-1+i/3 < 0 ? 0 : x-1+i/3 >= board_size_x ? board_size_x-1 : x-1+i/3;
-        short int pos_y = y-1+i%3 < 0 ? 0 : y-1+i%3 >= board_size_y ? board_size_y-1 : y-1+i%3;
-        if (std::find(searchList.begin(), searchList.end(), board.at(pos_x).at(pos_y)) != searchList.end()) {
-            std::vector<int> aux = {pos_x, pos_y};
-            if (std::find(result.begin(), result.end(), aux) == result.end()) result.push_back({pos_x, pos_y});
+template <typename BoardT>
+NeighbourList surroundingTiles(const BoardT& board, int x, int y, const char* searchList = "EM") {
+    NeighbourList result;
+    // Iterate through the surroundings from x,y position. Padding tiles never match the list.
+    board.forEachNeighbour(board.index(x, y), [&](int i) {
+        for (const char* search = searchList; *search; search++) {
+            if (board[i] == *search) {
+                result.push(i);
+                break;
+            }
         }
-    }
+    });
     return result;
 }
 
-/**
- * This function updates the board and at the end, prints it out.
- * @param board Board to be updated
- * @return returns true when the function finishes
- */ 
-bool updateBoard(std::vector<std::vector<char>>& board) {
-    int i = 0;
-    int j = 0;
-    int Width = 0;
-    int Height = 0;
-    int Bpp = 0;
-    std::vector<std::uint8_t> Pixels;
-    // Give the original game time to update the tiles accordingly
-    usleep(80000);
-
-    // Collect the new image from the board
-    ImageFromDisplay(Pixels, Width, Height, Bpp);
-    Mat img = Mat(Height, Width, Bpp > 24 ? CV_8UC4 : CV_8UC3, &Pixels[0]);
-
-    // That's kind of the same approach from the original board population in main() function
-    // TODO: Used this function in main()
+// Board tile for every TILE_STATE. A flag is a bomb already marked.
+const char TILE_CHARS[] = "012345678EM*X";
+// Name of every TILE_STATE in theme files
+const char* const TILE_NAMES[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "undiscovered", "flag", "mine", "exploded"};
+
+// Amount of points sampled on every tile by the glyph recognizer. Three are the fewest telling the 13 states
+// apart on the default theme, two already mix up some numbers.
+constexpr int GLYPH_POINTS = 3;
+// Area of a tile where the points can be, from its left border and from the row parseBoard() reads
+constexpr int GLYPH_WIDTH = 24;
+constexpr int GLYPH_HALF_HEIGHT = 11;
+constexpr int GLYPH_CANDIDATES = GLYPH_WIDTH*(2*GLYPH_HALF_HEIGHT+1);
+
+// Glyph signatures of a game theme. Every tile state is told apart by the colors at a few fixed points
+// of the tile, learned once for the theme.
+struct Theme {
+    bool ready = false;
+    // Points sampled on every tile, as x from the tile's left border and y from the row read
+    std::array<std::array<int, 2>, GLYPH_POINTS> points = {};
+    // Colors at the points, for every tile state
+    std::array<std::array<Vec4b, GLYPH_POINTS>, TILE_STATES> signatures = {};
+    std::array<bool, TILE_STATES> learned = {};
+    // Order the points are read in for a tile likely in every state, the ones telling it apart first
+    std::array<std::array<int, GLYPH_POINTS>, TILE_STATES> orders = {};
+    // Squared distance from every signature to the closest other one, over the first k+1 points read for a
+    // likely state, by likely state, k and state
+    std::array<std::array<std::array<long, TILE_STATES>, GLYPH_POINTS>, TILE_STATES> margins = {};
+    // Tiles classified with less confidence are left undiscovered, and read again on the next screenshot
+    float min_confidence = 0.3;
+};
 
-    // This corrector is needed for handling pixel issues when iterating through the rows.
-    // TODO: very likely the correction is needed on Y-axis
-    int corrector_x = 0;
-    int offset_row_max = 530+(board.size()-9)*25;
-    int offset_max = 260+(board[0].size()-9)*25;
-    for (int offset_row=318; offset_row < offset_row_max; offset_row += 25) {
-        j = 0;
-        int tile_counter = 0;
-        corrector_x = 0;
-        Vec4b real_color = {0, 0, 0, 0};
-        int counter = 0;
-        for (int offset=34; offset < offset_max; offset += 1) {
-            if (board.at(i).at(j) != 'E' || board.at(i).at(j) == '0' || board.at(i).at(j) == 'M' || board.at(i).at(j) == '9') {
-                std::cout << "Position kept as " << board.at(i).at(j) << " at " << i+1 << " " << j+1 << std::endl;
-                j += 1;
-                offset = 34+25*j;
-                tile_counter = 0;
-                counter = 0;
-                real_color = {0, 0, 0, 0};
-                continue;
-            }
-            corrector_x = j/2;
+// Colors seen on tiles with a known state, at every point a signature could use
+struct ThemeSamples {
+    // Sum and sum of squares of every channel, by state, point and channel
+    std::vector<double> sums;
+    std::vector<double> squares;
+    std::array<int, TILE_STATES> counts = {};
 
-            int x = offset + corrector_x;
-            int y = offset_row;
+    ThemeSamples() : sums(TILE_STATES*GLYPH_CANDIDATES*3, 0), squares(TILE_STATES*GLYPH_CANDIDATES*3, 0) {}
+};
 
-            Vec4b current_color = img.at<Vec4b>(y,x);
-            
-            if (tile_counter == 25 || ((260+(board[0].size()-9)*25)) - offset <= 1) {
-                tile_counter = 0;
-                COLOR color_verdict;
-                if (counter > 0) {
-                    color_verdict = colorIdentifier(real_color);
-                    printf("NEW Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, real_color.val[3],real_color.val[2],real_color.val[1], real_color.val[0], color_verdict);
-                } else {
-                    color_verdict = LIGHT_GRAY;
-                    printf("NEW Position: %i %i at x:%i y:%i :FORCED LIGHT GRAY, VERDICT: %i\n", i+1, j+1, x, y, color_verdict);
-                }
-                
-                real_color = {0, 0, 0, 0};
-                counter = 0;
-                if (color_verdict) {
-                    board.at(i).at(j) = (char)(48+color_verdict);
-                } else {
-                    // Need to know if tile was cliked, or not... The distinguishment will be done based on
-                    // the information that an unclicked-tile has a white pixel range on its border.
-                    
-                    // Begin at the tile's border
-                    int old_x = x;
-                    x = 34+25*j + corrector_x;
-                    while(x <= 34+25*(j+1)) {
-                        // Redo the average routine and color identification
-                        Vec4b color_intermediate = pixelAverage(img, x, y, 0);
-                        color_verdict = colorIdentifier(color_intermediate);
-                        printf("INTERMEDIATE Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, color_intermediate.val[3],color_intermediate.val[2],color_intermediate.val[1], color_intermediate.val[0], color_verdict);
+/**
+ * This function returns the state of a board tile
+ * @param tile Tile to be checked. Besides the board tiles, 'F' is also accepted as a flag
+ * @return returns the TILE_STATE, or -1 if the tile isn't a state the recognizer knows
+ */
+int tileState(char tile) {
+    if (tile == 'F') return TILE_FLAG;
+    const char* found = strchr(TILE_CHARS, tile);
+    if (tile == 0 || found == NULL) return -1;
+    return found - TILE_CHARS;
+}
 
-                        if (color_verdict == WHITE) {
-                            board.at(i).at(j) = 'E';
-                            x = old_x;
-                            break;
-                        } else if (34+25*(j+1)-x < 1) {
-                            board.at(i).at(j) = '0';
-                            x = old_x;
-                            break;
-                        }
-                        x++;
-                    }
-                    x = old_x;
-                }
-                j++;
-            } else {
-                if (current_color.val[2] > 110 && current_color.val[1] > 110 && current_color.val[0] > 110) {
-                    tile_counter++;
-                    continue;
-                } else {
-                    counter++;
-                    for (int aux = 0; aux < 4; aux++) {
-                        real_color.val[aux] = (real_color.val[aux]*(counter-1) + current_color.val[aux])/(counter);
-                    }
+/**
+ * This function collects the colors of every tile with a known state, to learn a theme from them
+ * @param img Screenshot to be used
+ * @param labels Board with the actual state of the tiles. Tiles with other chars are left out
+ * @param origin Origin of the board on the screenshot
+ * @param samples Samples where the colors are added
+ */
+template <typename BoardT>
+void collectSamples(Mat& img, const BoardT& labels, BoardOrigin origin, ThemeSamples& samples) {
+    for (int i = 0; i < labels.rows(); i++) {
+        for (int j = 0; j < labels.cols(); j++) {
+            int state = tileState(labels.at(i, j));
+            if (state < 0) continue;
+            // Same tile position parseBoard() uses
+            int x = 34+25*j + j/2 + origin.x;
+            int y = 318+25*i + origin.y;
+            for (int point = 0; point < GLYPH_CANDIDATES; point++) {
+                Vec4b color = img.at<Vec4b>(y + point/GLYPH_WIDTH - GLYPH_HALF_HEIGHT, x + point%GLYPH_WIDTH);
+                for (int c = 0; c < 3; c++) {
+                    int index = (state*GLYPH_CANDIDATES + point)*3 + c;
+                    samples.sums[index] += color.val[c];
+                    samples.squares[index] += color.val[c]*color.val[c];
                 }
             }
-            tile_counter++;
+            samples.counts[state]++;
         }
-        i++;
     }
-    
-    // Prints the board at the very end.
-    printBoard(board);
-    std::cout << std::endl << std::endl ;
-    return true;
 }
 
 /**
- * This function warps the mouse cursor to a given position, and performs a click action. After this, it
- * updates the board with the new positions discovered.
- * @param board Board to be updated
- * @param x X position to warp the cursor
- * @param y Y position to warp the cursor
- * @param action Action to take on click, either Left (REVEAL_TILE) or Right (MARK_BOMB)
- * @param delay Create a delay before and after the click for debug purposes. It's false by default
- * @return returns true at the end of the function.
+ * This function returns the squared distance between the colors at the theme's points
+ * @param a Colors at the points
+ * @param b Colors at the points
+ * @param points Amount of points compared, starting from the first one. It's GLYPH_POINTS by default
+ * @return returns the sum of the squared differences of every channel
  */
-bool warpAndClick(std::vector<std::vector<char>>& board, int x, int y, ACTION action, bool delay = false) {
-    Display* display = XOpenDisplay(nullptr);
+long glyphDistance(const Vec4b* a, const Vec4b* b, int points = GLYPH_POINTS) {
+    long distance = 0;
+    for (int k = 0; k < points; k++) {
+        for (int c = 0; c < 3; c++) {
+            int diff = a[k].val[c] - b[k].val[c];
+            distance += diff*diff;
+        }
+    }
+    return distance;
+}
+
+/**
+ * This function updates the order the points are read in for every likely state, and the margins between
+ * the signatures of a theme. One by one, every point is the one keeping the likely state the farthest from
+ * the closest other state, or else setting it apart from the most states.
+ * @param theme Theme to be updated
+ */
+void updateMargins(Theme& theme) {
+    for (int state = 0; state < TILE_STATES; state++) {
+        // Squared distance to every other state over the points ordered so far
+        std::array<long, TILE_STATES> distances = {};
+        std::array<bool, GLYPH_POINTS> ordered = {};
+        for (int k = 0; k < GLYPH_POINTS; k++) {
+            int best_point = -1;
+            long best_margin = -1;
+            int best_apart = -1;
+            for (int point = 0; point < GLYPH_POINTS; point++) {
+                if (ordered[point]) continue;
+                long margin = -1;
+                int apart = 0;
+                for (int other = 0; other < TILE_STATES; other++) {
+                    if (other == state || !theme.learned[state] || !theme.learned[other]) continue;
+                    long distance = distances[other] + glyphDistance(&theme.signatures[state][point], &theme.signatures[other][point], 1);
+                    if (margin < 0 || distance < margin) margin = distance;
+                    if (distance > 0) apart++;
+                }
+                if (best_point < 0 || margin > best_margin || (margin == best_margin && apart > best_apart)) {
+                    best_point = point;
+                    best_margin = margin;
+                    best_apart = apart;
+                }
+            }
+            ordered[best_point] = true;
+            for (int other = 0; other < TILE_STATES; other++) {
+                distances[other] += glyphDistance(&theme.signatures[state][best_point], &theme.signatures[other][best_point], 1);
+            }
+            theme.orders[state][k] = best_point;
+        }
+    }
+
+    for (int likely = 0; likely < TILE_STATES; likely++) {
+        for (int k = 0; k < GLYPH_POINTS; k++) {
+            for (int state = 0; state < TILE_STATES; state++) {
+                long& margin = theme.margins[likely][k][state];
+                margin = -1;
+                for (int other = 0; other < TILE_STATES; other++) {
+                    if (other == state || !theme.learned[state] || !theme.learned[other]) continue;
+                    long distance = 0;
+                    for (int read = 0; read <= k; read++) {
+                        int point = theme.orders[likely][read];
+                        distance += glyphDistance(&theme.signatures[state][point], &theme.signatures[other][point], 1);
+                    }
+                    if (margin < 0 || distance < margin) margin = distance;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * This function learns a theme from the samples collected. When the theme has no points yet, the points
+ * are chosen so the states seen are the easiest to tell apart: one by one, every point is the one adding
+ * the most separation between pairs of states not separated enough yet. Pixels changing between tiles of
+ * the same state count against a point. Otherwise the points are kept, and only the states seen are
+ * (re)learned at them, so a theme can be completed later on with states missing from the first screen.
+ * @param samples Samples collected
+ * @param theme Theme to be learned
+ * @return returns false if there weren't enough states to choose the points from
+ */
+bool learnTheme(const ThemeSamples& samples, Theme& theme) {
+    // Mean color, and how much it changes, of every state at every point
+    std::vector<double> means(samples.sums.size(), 0);
+    std::vector<double> spreads(TILE_STATES*GLYPH_CANDIDATES, 0);
+    std::vector<int> states;
+    for (int state = 0; state < TILE_STATES; state++) {
+        if (samples.counts[state] == 0) continue;
+        states.push_back(state);
+        for (int point = 0; point < GLYPH_CANDIDATES; point++) {
+            for (int c = 0; c < 3; c++) {
+                int index = (state*GLYPH_CANDIDATES + point)*3 + c;
+                means[index] = samples.sums[index]/samples.counts[state];
+                spreads[state*GLYPH_CANDIDATES + point] += samples.squares[index]/samples.counts[state] - means[index]*means[index];
+            }
+        }
+    }
+
+    if (!theme.ready) {
+        if (states.size() < 2) return false;
+        // Separation needed between two states, as a squared distance between colors
+        const double enough = 3*40*40;
+        std::vector<double> separation(states.size()*states.size(), 0);
+        std::vector<char> chosen(GLYPH_CANDIDATES, 0);
+        for (int k = 0; k < GLYPH_POINTS; k++) {
+            int best_point = 0;
+            double best_score = -1;
+            double best_total = -1;
+            for (int point = 0; point < GLYPH_CANDIDATES; point++) {
+                if (chosen[point]) continue;
+                // Once every pair is separated enough, the point adding the most separation is taken
+                double score = 0;
+                double total = 0;
+                for (std::size_t a = 0; a < states.size(); a++) {
+                    for (std::size_t b = a+1; b < states.size(); b++) {
+                        double distance = 0;
+                        for (int c = 0; c < 3; c++) {
+                            double diff = means[(states[a]*GLYPH_CANDIDATES + point)*3 + c] - means[(states[b]*GLYPH_CANDIDATES + point)*3 + c];
+                            distance += diff*diff;
+                        }
+                        distance -= 4*(spreads[states[a]*GLYPH_CANDIDATES + point] + spreads[states[b]*GLYPH_CANDIDATES + point]);
+                        score += std::min(separation[a*states.size() + b] + std::max(distance, 0.0), enough);
+                        total += std::max(distance, 0.0);
+                    }
+                }
+                if (score > best_score || (score == best_score && total > best_total)) {
+                    best_score = score;
+                    best_total = total;
+                    best_point = point;
+                }
+            }
+            chosen[best_point] = 1;
+            theme.points[k] = {best_point%GLYPH_WIDTH, best_point/GLYPH_WIDTH - GLYPH_HALF_HEIGHT};
+            for (std::size_t a = 0; a < states.size(); a++) {
+                for (std::size_t b = a+1; b < states.size(); b++) {
+                    double distance = 0;
+                    for (int c = 0; c < 3; c++) {
+                        double diff = means[(states[a]*GLYPH_CANDIDATES + best_point)*3 + c] - means[(states[b]*GLYPH_CANDIDATES + best_point)*3 + c];
+                        distance += diff*diff;
+                    }
+                    separation[a*states.size() + b] += distance;
+                }
+            }
+        }
+        theme.ready = true;
+    }
+
+    for (int state : states) {
+        for (int k = 0; k < GLYPH_POINTS; k++) {
+            int point = (theme.points[k][1] + GLYPH_HALF_HEIGHT)*GLYPH_WIDTH + theme.points[k][0];
+            Vec4b color = {0, 0, 0, 255};
+            for (int c = 0; c < 3; c++) color.val[c] = (uchar)(means[(state*GLYPH_CANDIDATES + point)*3 + c] + 0.5);
+            theme.signatures[state][k] = color;
+        }
+        theme.learned[state] = true;
+    }
+    updateMargins(theme);
+    return true;
+}
+
+/**
+ * This function tells the state of a tile from the colors at the theme's points only
+ * @param img Screenshot to be used
+ * @param theme Theme of the game
+ * @param x X position of the tile's left border
+ * @param y Y position of the row read
+ * @param confidence How far the closest state is from the second closest one. It goes from 0 (both as close)
+ * to 1 (exact match, or a single state learned)
+ * @param likely State expected for the tile. The points are read one at a time, the ones telling it apart
+ * first, and reading stops as soon as the tile is close enough to one state on the points read. It's
+ * TILE_UNDISCOVERED by default, since only undiscovered tiles are read
+ * @return returns the closest TILE_STATE, or -1 if the theme has no states
+ */
+int classifyTile(Mat& img, const Theme& theme, int x, int y, float& confidence, int likely = TILE_UNDISCOVERED) {
+    Vec4b colors[GLYPH_POINTS];
+    // Distance to every state over the points read so far. Only the likely state's is kept while the tile
+    // can still be it, which is the common case, and the others catch up once it can't.
+    long distances[TILE_STATES];
+    distances[likely] = 0;
+    bool others = false;
+    auto add = [&](int point, bool likely_too) {
+        for (int state = 0; state < TILE_STATES; state++) {
+            if (theme.learned[state] && (state != likely || likely_too)) distances[state] += glyphDistance(&colors[point], &theme.signatures[state][point], 1);
+        }
+    };
+    // Starts keeping the distances of the other states, from the first points read
+    auto catchUp = [&](int read) {
+        for (int state = 0; state < TILE_STATES; state++) {
+            if (state != likely) distances[state] = 0;
+        }
+        for (int k = 0; k < read; k++) add(theme.orders[likely][k], false);
+        others = true;
+    };
+    // Close enough to a state on the points read so far, every other one is known to be far on them
+    // without reading the rest: it's at least the margin minus this distance away (in plain, not squared,
+    // distance). Only one state can be that close.
+    auto close = [&](int state, long margin) {
+        if (margin <= 0 || 16*distances[state] > margin) return false;
+        double away = std::sqrt((double)margin) - std::sqrt((double)distances[state]);
+        away *= away;
+        confidence = (float)((away - distances[state])/(away + distances[state]));
+        return true;
+    };
+
+    if (!theme.learned[likely]) catchUp(0);
+    for (int k = 0; k < GLYPH_POINTS; k++) {
+        int point = theme.orders[likely][k];
+        colors[point] = img.at<Vec4b>(y + theme.points[point][1], x + theme.points[point][0]);
+        if (!others) {
+            distances[likely] += glyphDistance(&colors[point], &theme.signatures[likely][point], 1);
+            long margin = theme.margins[likely][k][likely];
+            if (close(likely, margin)) return likely;
+            // The points read so far can't tell yet
+            if (margin <= 0) continue;
+            catchUp(k+1);
+        } else {
+            add(point, true);
+        }
+        for (int state = 0; state < TILE_STATES; state++) {
+            if (theme.learned[state] && close(state, theme.margins[likely][k][state])) return state;
+        }
+    }
+    if (!others) catchUp(GLYPH_POINTS);
+
+    int best = -1;
+    long best_distance = 0;
+    long second_distance = -1;
+    for (int state = 0; state < TILE_STATES; state++) {
+        if (!theme.learned[state]) continue;
+        long distance = distances[state];
+        if (best < 0 || distance < best_distance) {
+            second_distance = best < 0 ? -1 : best_distance;
+            best_distance = distance;
+            best = state;
+        } else if (second_distance < 0 || distance < second_distance) {
+            second_distance = distance;
+        }
+    }
+    if (second_distance < 0) confidence = 1;
+    else if (second_distance == 0) confidence = 0;
+    else confidence = (float)(second_distance - best_distance)/(second_distance + best_distance);
+    return best;
+}
+
+/**
+ * This function reads the undiscovered tiles (E) of the board from a screenshot, with the glyph signatures
+ * of a theme. At most GLYPH_POINTS pixels are read for every tile, and usually two for one still undiscovered.
+ * @param img Screenshot to be parsed
+ * @param board Board to be updated
+ * @param verbose Print every tile decision
+ * @param origin Origin of the board on the screenshot
+ * @param theme Theme of the game
+ */
+template <typename BoardT>
+void parseBoardGlyphs(Mat& img, BoardT& board, bool verbose, BoardOrigin origin, const Theme& theme) {
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) {
+            if (board.at(i, j) != 'E') continue;
+            // Same correction parseBoard() uses for the pixel issues through the row
+            int x = 34+25*j + j/2 + origin.x;
+            int y = 318+25*i + origin.y;
+            float confidence = 0;
+            int state = classifyTile(img, theme, x, y, confidence);
+            if (state < 0 || confidence < theme.min_confidence) {
+                if (verbose) printf("GLYPH Position: %i %i at x:%i y:%i : UNSURE, CONFIDENCE: %.2f\n", i+1, j+1, x, y, confidence);
+                continue;
+            }
+            board.at(i, j) = TILE_CHARS[state];
+            if (verbose) printf("GLYPH Position: %i %i at x:%i y:%i : %s, CONFIDENCE: %.2f\n", i+1, j+1, x, y, TILE_NAMES[state], confidence);
+        }
+    }
+}
+
+/**
+ * This function saves a theme to a file
+ * @param path File to be written
+ * @param theme Theme to be saved
+ * @return returns false if the file can't be written
+ */
+bool saveTheme(const char* path, const Theme& theme) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return false;
+    fprintf(file, "points");
+    for (auto &point : theme.points) fprintf(file, " %d %d", point[0], point[1]);
+    fprintf(file, "\n");
+    for (int state = 0; state < TILE_STATES; state++) {
+        if (!theme.learned[state]) continue;
+        fprintf(file, "%s", TILE_NAMES[state]);
+        for (auto &color : theme.signatures[state]) fprintf(file, " %d %d %d", color.val[2], color.val[1], color.val[0]);
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * This function loads a theme saved by saveTheme()
+ * @param path File to be read
+ * @param theme Theme to be loaded
+ * @return returns false if the file can't be read
+ */
+bool loadTheme(const char* path, Theme& theme) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return false;
+    bool valid = fscanf(file, " points") == 0;
+    for (auto &point : theme.points) {
+        if (fscanf(file, "%d %d", &point[0], &point[1]) != 2) valid = false;
+    }
+    char name[32];
+    while (valid && fscanf(file, "%31s", name) == 1) {
+        int state = 0;
+        while (state < TILE_STATES && strcmp(name, TILE_NAMES[state]) != 0) state++;
+        if (state == TILE_STATES) {
+            valid = false;
+            break;
+        }
+        for (auto &color : theme.signatures[state]) {
+            int R, G, B;
+            if (fscanf(file, "%d %d %d", &R, &G, &B) != 3) valid = false;
+            color = Vec4b(B, G, R, 255);
+        }
+        theme.learned[state] = true;
+    }
+    fclose(file);
+    theme.ready = valid;
+    updateMargins(theme);
+    return valid;
+}
+
+/**
+ * This function reads the undiscovered tiles (E) of the board from a screenshot. Tiles already known
+ * are kept as they are.
+ * @param img Screenshot to be parsed
+ * @param board Board to be updated
+ * @param verbose Print every tile decision. It's true by default
+ * @param origin Origin of the board on the screenshot. It's (0, 0) by default
+ * @param theme Theme with the glyph signatures of the game. When given, tiles are read from the signatures
+ * instead. It's nullptr by default
+ */
+template <typename BoardT>
+void parseBoard(Mat& img, BoardT& board, bool verbose = true, BoardOrigin origin = BoardOrigin(), const Theme* theme = nullptr) {
+    if (theme != nullptr && theme->ready) {
+        parseBoardGlyphs(img, board, verbose, origin, *theme);
+        return;
+    }
+
+    int i = 0;
+    int j = 0;
+
+    // That's kind of the same approach from the original board population in main() function
+    // TODO: Used this function in main()
+
+    // This corrector is needed for handling pixel issues when iterating through the rows.
+    // TODO: very likely the correction is needed on Y-axis
+    int corrector_x = 0;
+    int offset_row_max = 530+(board.rows()-9)*25;
+    int offset_max = 260+(board.cols()-9)*25;
+    for (int offset_row=318; offset_row < offset_row_max; offset_row += 25) {
+        j = 0;
+        int tile_counter = 0;
+        corrector_x = 0;
+        Vec4b real_color = {0, 0, 0, 0};
+        int counter = 0;
+        for (int offset=34; offset < offset_max; offset += 1) {
+            if (board.at(i, j) != 'E' || board.at(i, j) == '0' || board.at(i, j) == 'M' || board.at(i, j) == '9') {
+                if (verbose) std::cout << "Position kept as " << board.at(i, j) << " at " << i+1 << " " << j+1 << std::endl;
+                j += 1;
+                offset = 34+25*j;
+                tile_counter = 0;
+                counter = 0;
+                real_color = {0, 0, 0, 0};
+                continue;
+            }
+            corrector_x = j/2;
+
+            int x = offset + corrector_x + origin.x;
+            int y = offset_row + origin.y;
+
+            Vec4b current_color = img.at<Vec4b>(y,x);
+            
+            if (tile_counter == 25 || ((260+(board.cols()-9)*25)) - offset <= 1) {
+                tile_counter = 0;
+                COLOR color_verdict;
+                if (counter > 0) {
+                    color_verdict = colorIdentifier(real_color);
+                    if (verbose) printf("NEW Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, real_color.val[3],real_color.val[2],real_color.val[1], real_color.val[0], color_verdict);
+                } else {
+                    color_verdict = LIGHT_GRAY;
+                    if (verbose) printf("NEW Position: %i %i at x:%i y:%i :FORCED LIGHT GRAY, VERDICT: %i\n", i+1, j+1, x, y, color_verdict);
+                }
+                
+                real_color = {0, 0, 0, 0};
+                // A number only covers the middle of its tile. A row colored almost from border to border is
+                // the red background of an exploded mine, which would be averaged into a number otherwise.
+                bool exploded = counter > 18;
+                counter = 0;
+                if (exploded) {
+                    board.at(i, j) = 'X';
+                } else if (color_verdict) {
+                    board.at(i, j) = (char)(48+color_verdict);
+                } else {
+                    // Need to know if tile was cliked, or not... The distinguishment will be done based on
+                    // the information that an unclicked-tile has a white pixel range on its border.
+                    
+                    // Begin at the tile's border
+                    int old_x = x;
+                    x = 34+25*j + corrector_x + origin.x;
+                    while(x <= 34+25*(j+1) + origin.x) {
+                        // Redo the average routine and color identification
+                        Vec4b color_intermediate = pixelAverage(img, x, y, 0);
+                        color_verdict = colorIdentifier(color_intermediate);
+                        if (verbose) printf("INTERMEDIATE Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, color_intermediate.val[3],color_intermediate.val[2],color_intermediate.val[1], color_intermediate.val[0], color_verdict);
+
+                        if (color_verdict == WHITE) {
+                            board.at(i, j) = 'E';
+                            x = old_x;
+                            break;
+                        } else if (34+25*(j+1) + origin.x - x < 1) {
+                            board.at(i, j) = '0';
+                            x = old_x;
+                            break;
+                        }
+                        x++;
+                    }
+                    x = old_x;
+                }
+                j++;
+            } else {
+                if (current_color.val[2] > 110 && current_color.val[1] > 110 && current_color.val[0] > 110) {
+                    tile_counter++;
+                    continue;
+                } else {
+                    counter++;
+                    for (int aux = 0; aux < 4; aux++) {
+                        real_color.val[aux] = (real_color.val[aux]*(counter-1) + current_color.val[aux])/(counter);
+                    }
+                }
+            }
+            tile_counter++;
+        }
+        i++;
+    }
+}
+
+/**
+ * This function checks if there's a white pixel, the border of an undiscovered tile, at a given position.
+ * One pixel to each side is also accepted.
+ * @param img Screenshot to be used
+ * @param x X position
+ * @param y Y position
+ * @return returns true if a white pixel was found
+ */
+bool whiteAround(Mat& img, int x, int y) {
+    for (int k = x-1; k <= x+1; k++) {
+        if (k >= 0 && k < img.cols && colorIdentifier(img.at<Vec4b>(y,k)) == WHITE) return true;
+    }
+    return false;
+}
+
+/**
+ * This function checks if every tile of a board, with its first tile border at x, y, is undiscovered
+ * @param img Screenshot to be used
+ * @param x X position of the first tile's border
+ * @param y Y position of the first row
+ * @param rows Amount of rows
+ * @param cols Amount of columns
+ * @return returns true if a whole board of undiscovered tiles is found
+ */
+bool undiscoveredBoardAt(Mat& img, int x, int y, int rows, int cols) {
+    for (int i = 0; i < rows; i++) {
+        // Same correction parseBoard() uses for the pixel issues through the row
+        for (int j = 0; j < cols; j++) {
+            if (!whiteAround(img, x+25*j + j/2, y+25*i)) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * This function finds every board with the given size on a screenshot. The boards are found by their
+ * undiscovered tiles, so it must be used before the games start, with every tile undiscovered.
+ * @param img Screenshot to be searched
+ * @param rows Amount of rows of the boards
+ * @param cols Amount of columns of the boards
+ * @return returns the origins of the boards found, from top to bottom and left to right
+ */
+std::vector<BoardOrigin> locateBoards(Mat& img, int rows, int cols) {
+    std::vector<BoardOrigin> origins;
+    // Screen areas already taken by a board found, as left, top, right and bottom
+    std::vector<std::array<int, 4>> taken;
+    int board_width = 25*cols + cols/2;
+    for (int y = 0; y + 25*(rows-1) < img.rows; y++) {
+        for (int x = 1; x + board_width < img.cols; x++) {
+            // Only the beginning of a white border is a candidate
+            if (colorIdentifier(img.at<Vec4b>(y,x)) != WHITE || colorIdentifier(img.at<Vec4b>(y,x-1)) == WHITE) continue;
+            bool inside = false;
+            for (auto &area : taken) {
+                if (x >= area[0] && x <= area[2] && y >= area[1] && y <= area[3]) inside = true;
+            }
+            if (inside || !undiscoveredBoardAt(img, x, y, rows, cols)) continue;
+            // A bigger board would have undiscovered tiles right before or after this one
+            if ((x >= 26 && whiteAround(img, x-25, y)) || whiteAround(img, x+board_width, y)) continue;
+
+            // The white border runs down the tile, the rows are read at its middle
+            int bottom = y;
+            while (bottom+1 + 25*(rows-1) < img.rows && undiscoveredBoardAt(img, x, bottom+1, rows, 1)) bottom++;
+            BoardOrigin origin;
+            origin.x = x - 34;
+            origin.y = (y+bottom)/2 - 318;
+            origins.push_back(origin);
+            taken.push_back({x-1, y, x+board_width, y+25*rows});
+            std::cout << "Board found at " << origin.x << "," << origin.y << std::endl;
+        }
+    }
+    return origins;
+}
+
+// Amount of pixels read around the smiling face's center, to each side
+constexpr int SMILEY_RADIUS = 6;
+
+// What's needed to tell when a game is over, and how it ended
+struct GameWatch {
+    // Amount of bombs of the board. When it's 0, only the face tells the game is over
+    int mines = 0;
+    BoardOrigin origin;
+    // Pixels of the smiling face while the game is in progress, read when the game starts
+    std::vector<Vec4b> smiley;
+    GAME_STATE state = IN_PROGRESS;
+};
+
+/**
+ * This function reads the smiling face of a game
+ * @param img Screenshot to be used
+ * @param cols Amount of columns of the board, the face is centered above them
+ * @param origin Origin of the board
+ * @return returns the pixels around the face's center. It's empty if the face isn't on the screenshot
+ */
+std::vector<Vec4b> readSmiley(Mat& img, int cols, BoardOrigin origin) {
+    std::vector<Vec4b> pixels;
+    // Smiling face's position
+    int x = 150+(cols-9)*12.666 + origin.x;
+    int y = 265 + origin.y;
+    if (x < SMILEY_RADIUS || y < SMILEY_RADIUS || x+SMILEY_RADIUS >= img.cols || y+SMILEY_RADIUS >= img.rows) return pixels;
+    for (int j = -SMILEY_RADIUS; j <= SMILEY_RADIUS; j++) {
+        for (int k = -SMILEY_RADIUS; k <= SMILEY_RADIUS; k++) pixels.push_back(img.at<Vec4b>(y+k, x+j));
+    }
+    return pixels;
+}
+
+/**
+ * This function tells how a game is going from its board. The game is lost when a mine shows up, and won
+ * when only the bombs are left undiscovered. A face no longer smiling also means the game is over: won
+ * if no tile is left undiscovered besides the known bombs, lost otherwise.
+ * @param board Board to be checked
+ * @param mines Amount of bombs of the board. When it's 0, the tiles left undiscovered can't tell a win
+ * @param face_changed The face is no longer the one of a game in progress
+ * @return returns the GAME_STATE
+ */
+template <typename BoardT>
+GAME_STATE gameState(const BoardT& board, int mines, bool face_changed) {
+    int undiscovered = 0;
+    int unknown = 0;
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) {
+            char tile = board.at(i, j);
+            if (tile == 'X' || tile == '*') return LOST;
+            if (tile == 'E' || tile == 'M') undiscovered++;
+            if (tile == 'E') unknown++;
+        }
+    }
+    if (mines > 0 && undiscovered == mines) return WON;
+    if (face_changed) return unknown == 0 ? WON : LOST;
+    return IN_PROGRESS;
+}
+
+/**
+ * This function tells if the smiling face of a game is no longer the one read while it was in progress
+ * @param img Screenshot to be used
+ * @param cols Amount of columns of the board
+ * @param watch Game being watched
+ * @return returns true if the face changed, false otherwise or if it was never read
+ */
+bool faceChanged(Mat& img, int cols, const GameWatch& watch) {
+    std::vector<Vec4b> smiley = readSmiley(img, cols, watch.origin);
+    if (watch.smiley.size() == 0 || smiley.size() != watch.smiley.size()) return false;
+    // Average difference of every channel, the numbers are empiric
+    long difference = 0;
+    for (std::size_t p = 0; p < smiley.size(); p++) {
+        for (int c = 0; c < 3; c++) difference += std::abs(smiley[p].val[c] - watch.smiley[p].val[c]);
+    }
+    return difference > 24*3*(long)smiley.size();
+}
+
+/**
+ * This function checks how the game is going, from a screenshot and the board just parsed from it
+ * @param img Screenshot to be used
+ * @param board Board parsed from the screenshot
+ * @param watch Game being watched. Its state is updated
+ * @return returns the GAME_STATE
+ */
+template <typename BoardT>
+GAME_STATE watchGame(Mat& img, const BoardT& board, GameWatch& watch) {
+    watch.state = gameState(board, watch.mines, faceChanged(img, board.cols(), watch));
+    return watch.state;
+}
+
+/**
+ * This function updates the board and at the end, prints it out.
+ * @param board Board to be updated
+ * @param theme Theme with the glyph signatures of the game, if any. It's nullptr by default
+ * @param watch Game to be checked for its end, if any. It's nullptr by default
+ * @return returns true when the function finishes
+ */ 
+template <typename BoardT>
+bool updateBoard(BoardT& board, const Theme* theme = nullptr, GameWatch* watch = nullptr) {
+    int Width = 0;
+    int Height = 0;
+    int Bpp = 0;
+    std::vector<std::uint8_t> Pixels;
+    // Give the original game time to update the tiles accordingly
+    usleep(80000);
+
+    // Collect the new image from the board
+    ImageFromDisplay(Pixels, Width, Height, Bpp);
+    Mat img = Mat(Height, Width, Bpp > 24 ? CV_8UC4 : CV_8UC3, &Pixels[0]);
+    parseBoard(img, board, true, BoardOrigin(), theme);
+    if (watch != nullptr) watchGame(img, board, *watch);
+
+    // Prints the board at the very end.
+    printBoard(board);
+    std::cout << std::endl << std::endl ;
+    return true;
+}
+
+/**
+ * This function warps the mouse cursor to a given position, and performs a click action.
+ * @param x X position to warp the cursor
+ * @param y Y position to warp the cursor
+ * @param action Action to take on click, either Left (REVEAL_TILE and CHORD_TILE) or Right (MARK_BOMB)
+ * @param delay Create a delay before and after the click for debug purposes. It's false by default
+ * @param origin Origin of the board the position belongs to. x and y are given as for a board at (0, 0)
+ * @param shared Connection to the X server to be used. A new one is opened when it's nullptr (default)
+ */
+void clickAt(int x, int y, ACTION action, bool delay = false, const BoardOrigin& origin = BoardOrigin(), Display* shared = nullptr) {
+    Display* display = shared ? shared : XOpenDisplay(nullptr);
     Window root = DefaultRootWindow(display);
     // This correction is needed to overcome issues with pixel count and warpings.
     // Totally empiric
     int j = (x-46)/25;
     int corrector = 4*j/9;
     // TODO: Instead of using x and y already in pixel position, let's do the conversion here.
-    XWarpPointer (display, None, root, 0,0,0,0, x+corrector, y);
+    XWarpPointer (display, None, root, 0,0,0,0, x+corrector+origin.x, y+origin.y);
     XFlush(display);
-    XCloseDisplay(display);
+    if (!shared) XCloseDisplay(display);
+    // Chording is also a left click, only on top of a numbered tile
+    int button = action == MARK_BOMB ? Button3 : Button1;
     // This mask is used to ensure the left/right clicks are done without influence from other
     // clicks.
-    int mask = action == Button1 ? 0x001 : 0x002;
+    int mask = button == Button1 ? 0x001 : 0x002;
     if (delay) sleep(1);
-    mouseClick(action, mask);
+    mouseClick(button, mask, shared);
     if (delay) sleep(1);
-    // Only needs to update board if the action is REVEAL_TILE
-    if (action == REVEAL_TILE) updateBoard(board);
-    return true;
+}
+
+/**
+ * This function warps the mouse cursor to a given screen position, and performs a left click. It's used
+ * outside the tiles, where no correction is needed.
+ * @param x X position to warp the cursor
+ * @param y Y position to warp the cursor
+ * @param shared Connection to the X server to be used. A new one is opened when it's nullptr (default)
+ */
+void pressAt(int x, int y, Display* shared = nullptr) {
+    Display* display = shared ? shared : XOpenDisplay(nullptr);
+    Window root = DefaultRootWindow(display);
+    // Move pointer to the position desired
+    XWarpPointer (display, None, root, 0,0,0,0, x, y);
+    // Needs to flush in order to do the movement
+    XFlush(display);
+    // Close the display whenever it was previously opened by XOpenDisplay function
+    if (!shared) XCloseDisplay(display);
+    // Finally, clicks with the left mouse button. Use the mask to ensure only the left button is pressed.
+    mouseClick(Button1, 0x001, shared);
+}
+
+/**
+ * This function performs a batch of planned moves, one after another, and updates the board once at
+ * the end. Every move in the batch was decided from the same board, so there's no need to look at the
+ * screen in between.
+ * @param board Board to be updated after the batch
+ * @param moves Moves to be performed
+ * @param theme Theme with the glyph signatures of the game, if any. It's nullptr by default
+ * @param watch Game to be checked for its end, if any. It's nullptr by default
+ */
+template <typename BoardT>
+void executeMoves(BoardT& board, const std::vector<Move>& moves, const Theme* theme = nullptr, GameWatch* watch = nullptr) {
+    bool revealed = false;
+    for (auto &move : moves) {
+        clickAt(46+25*(move.y), 318+25*(move.x), move.action);
+        if (move.action != MARK_BOMB) revealed = true;
+    }
+    if (revealed) updateBoard(board, theme, watch);
 }
 
 /**
@@ -389,75 +1766,78 @@ bool vectorInside(std::vector<std::vector<int>> major, std::vector<std::vector<i
  * @param surroundings List of surrounding tiles (E and M) from original tile
  * @param results List of surrounding tiles (E) from original tile
  * @param bomb_counter Amount of bombs in the surrounding of the original tile
+ * @param arena Scratch memory of the current board run, where the moves decided are stored
  * @return returns true if a modification was done in the board, false if not
  */
-bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x, int pivot_y, std::vector<std::vector<int>> surroundings, std::vector<std::vector<int>> results, int bomb_counter) {
+template <typename BoardT>
+bool pivotBoard(BoardT& board, int x, int y, int pivot_x, int pivot_y, const NeighbourList& surroundings, const NeighbourList& results, int bomb_counter, SolveArena& arena) {
     // TODO: does this function needs so many arguments?
-    int bombs = board.at(x).at(y)-48;
-    char pivot = board.at(pivot_x).at(pivot_y);
+    int bombs = board.at(x, y)-48;
+    char pivot = board.at(pivot_x, pivot_y);
     if (pivot != 'E' && pivot != '0' && pivot != 'M') {
-        std::cout << "Valid pivoting at " << x+1 << " " << y+1 << std::endl;
-        std::cout << "Pivot position is: " << pivot_x+1 << " " << pivot_y+1 << std::endl;
-        int pivot_bombs = board.at(pivot_x).at(pivot_y)-48;
+        *solver_log << "Valid pivoting at " << x+1 << " " << y+1 << std::endl;
+        *solver_log << "Pivot position is: " << pivot_x+1 << " " << pivot_y+1 << std::endl;
+        int pivot_bombs = board.at(pivot_x, pivot_y)-48;
         int pivot_bomb_counter = 0;
-        std::vector<std::vector<int>> pivot_results;
-        std::vector<std::vector<int>> pivot_surroundings = surroundingTiles(board, pivot_x, pivot_y);
+        NeighbourList pivot_results;
+        NeighbourList pivot_surroundings = surroundingTiles(board, pivot_x, pivot_y);
         
         // Separate marked bombs from bomb-candidates for pivot
         if (pivot_surroundings.size() > 0) {
-            std::cout << "Pivot surroundings results are: ";
-            for (auto &i : surroundingTiles(board, pivot_x, pivot_y)) {
-                if (board.at(i[0]).at(i[1]) != 'M') {
-                    pivot_results.emplace_back(i);
-                    std::cout << i[0]+1 << " " << i[1]+1 << " ";
+            *solver_log << "Pivot surroundings results are: ";
+            for (int i : pivot_surroundings) {
+                if (board[i] != 'M') {
+                    pivot_results.push(i);
+                    *solver_log << board.row(i)+1 << " " << board.col(i)+1 << " ";
                 } else {
-                    std::cout << "\nIncreasing pivot bomb counter due to position " << i[0]+1 << " " << i[1]+1 << std::endl;
-                    std::cout << "At this position, it was found: " << board.at(i[0]).at(i[1]) << std::endl;
+                    *solver_log << "\nIncreasing pivot bomb counter due to position " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                    *solver_log << "At this position, it was found: " << board[i] << std::endl;
                     pivot_bomb_counter++;
                 }
             }
         }
-        std::cout << std::endl;
+        *solver_log << std::endl;
 
         int pivot_expected_bombs = pivot_bombs - pivot_bomb_counter;
-        std::cout << "Bomb count for pivot is " << pivot_bomb_counter << std::endl;
-        std::cout << pivot_expected_bombs << " bombs are expected in these surroundings for pivot" << std::endl;
+        *solver_log << "Bomb count for pivot is " << pivot_bomb_counter << std::endl;
+        *solver_log << pivot_expected_bombs << " bombs are expected in these surroundings for pivot" << std::endl;
 
         // Get tile's intersection:
-        std::vector<std::vector<int>> results_intersection;
-        std::vector<std::vector<int>> results_not_intersection;
-        for (std::vector<std::vector<int>>::iterator i = results.begin(); i != results.end(); i++) {
-            if (std::find(pivot_results.begin(), pivot_results.end(), *i) != pivot_results.end()) {
-                std::cout << "Intersection found at " << i->at(0)+1 << " " << i->at(1)+1 << std::endl;
-                results_intersection.emplace_back(*i);
+        NeighbourList results_intersection;
+        // Both tiles are side by side, so together they have at most 10 other tiles around them
+        TileList<10> results_not_intersection;
+        for (int i : results) {
+            if (std::find(pivot_results.begin(), pivot_results.end(), i) != pivot_results.end()) {
+                *solver_log << "Intersection found at " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                results_intersection.push(i);
             } else {
-                if (board.at(i->at(0)).at(i->at(1)) != 'M') {
-                    std::cout << "Intersection NOT found at " << i->at(0)+1 << " " << i->at(1)+1 << std::endl;
-                    results_not_intersection.emplace_back(*i);
+                if (board[i] != 'M') {
+                    *solver_log << "Intersection NOT found at " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                    results_not_intersection.push(i);
                 }
             }
         }
 
         // Get positions from pivot which weren't intersected
-        std::vector<std::vector<int>> pivot_not_intersection;
-        for (std::vector<std::vector<int>>::iterator i = pivot_surroundings.begin(); i != pivot_surroundings.end(); i++) {
-            if (std::find(results_intersection.begin(), results_intersection.end(), *i) == results_intersection.end()) {
-                if (board.at(i->at(0)).at(i->at(1)) != 'M') {
-                    std::cout << "After reading the pivot surroundings, adding " << i->at(0)+1 << " " << i->at(1)+1 << " to NOT INTERSECTION" << std::endl;
-                    results_not_intersection.emplace_back(*i);
-                    pivot_not_intersection.emplace_back(*i);
+        NeighbourList pivot_not_intersection;
+        for (int i : pivot_surroundings) {
+            if (std::find(results_intersection.begin(), results_intersection.end(), i) == results_intersection.end()) {
+                if (board[i] != 'M') {
+                    *solver_log << "After reading the pivot surroundings, adding " << board.row(i)+1 << " " << board.col(i)+1 << " to NOT INTERSECTION" << std::endl;
+                    results_not_intersection.push(i);
+                    pivot_not_intersection.push(i);
                 }
             }
         }
 
         int expected_bombs = bombs - bomb_counter;
 
-        std::cout << "Expected bombs in original tile is " << expected_bombs << std::endl;
-        std::cout << "Original tile surroundings are:";
-        for (auto &i : surroundings) {
-            std::cout << " " << i[0]+1 << " " << i[1]+1 ; 
+        *solver_log << "Expected bombs in original tile is " << expected_bombs << std::endl;
+        *solver_log << "Original tile surroundings are:";
+        for (int i : surroundings) {
+            *solver_log << " " << board.row(i)+1 << " " << board.col(i)+1 ; 
         }
-        std::cout << std::endl;
+        *solver_log << std::endl;
 
         // If the pivot expected bombs are bigger than the expected bombs in original tile, and if
         // the non-intersected tiles list from pivot aren't empty, we can mark bombs from this list.
@@ -473,17 +1853,17 @@ bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x
        // all tiles from this list as bombs.
         if (pivot_expected_bombs > expected_bombs) {
             if (pivot_not_intersection.size() == 0) return false;
-            std::cout << "More pivot expected bombs than original expected bombs..." << std::endl;
-            std::cout << "Pivot expected: " << pivot_expected_bombs << std::endl;
-            std::cout << "Original expected: " << expected_bombs << std::endl;
+            *solver_log << "More pivot expected bombs than original expected bombs..." << std::endl;
+            *solver_log << "Pivot expected: " << pivot_expected_bombs << std::endl;
+            *solver_log << "Original expected: " << expected_bombs << std::endl;
             int difference = pivot_expected_bombs - expected_bombs;
             if (difference == (int)pivot_not_intersection.size()) {
-                std::cout << "Pivoting taking place!" << std::endl;
-                std::cout << "Since this invalidates the original tile, then marking the other pivot tiles as bombs!" << std::endl;
-                for (auto &i : pivot_not_intersection) {
-                    std::cout << "Marking bomb at " << i[0]+1 << " " << i[1]+1 << std::endl;
-                    board.at(i[0]).at(i[1]) = 'M';
-                    warpAndClick(board, 46+25*(i[1]), 318+25*(i[0]), MARK_BOMB, false);
+                *solver_log << "Pivoting taking place!" << std::endl;
+                *solver_log << "Since this invalidates the original tile, then marking the other pivot tiles as bombs!" << std::endl;
+                for (int i : pivot_not_intersection) {
+                    *solver_log << "Marking bomb at " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                    board[i] = 'M';
+                    arena.push(i, {board.row(i), board.col(i), MARK_BOMB});
                 }
                 return true;
             }
@@ -504,12 +1884,12 @@ bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x
        // (Positions 3,2 and 3,3). So, the other tiles (Positions 1,4 and 3,4) can be freed.
         if (pivot_expected_bombs == expected_bombs && std::equal(pivot_surroundings.begin(), pivot_surroundings.end(), results_intersection.begin(), results_intersection.end())) {
             if (results_not_intersection.size() == 0) return false;
-            std::cout << "Pivoting taking place!" << std::endl;
-            std::cout << "Surroundings from original tile are the same from the results intersection" << std::endl;
-            std::cout << "We can free all other tiles not in the intersection!" << std::endl;
-            for (auto &i : results_not_intersection) {
-                std::cout << "Revealing tile " << i[0]+1 << " " << i[1]+1 << std::endl;
-                warpAndClick(board, 46+25*(i[1]), 318+25*(i[0]), REVEAL_TILE, false);
+            *solver_log << "Pivoting taking place!" << std::endl;
+            *solver_log << "Surroundings from original tile are the same from the results intersection" << std::endl;
+            *solver_log << "We can free all other tiles not in the intersection!" << std::endl;
+            for (int i : results_not_intersection) {
+                *solver_log << "Revealing tile " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                arena.push(i, {board.row(i), board.col(i), REVEAL_TILE});
             }
             return true;
         }
@@ -518,12 +1898,12 @@ bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x
         // and finally freeing the non-intersecting tiles from the pivot.
         if (pivot_expected_bombs == expected_bombs && std::equal(results.begin(), results.end(), results_intersection.begin(), results_intersection.end())) {
             if (pivot_not_intersection.size() == 0) return false;
-            std::cout << "Pivoting taking place!" << std::endl;
-            std::cout << "Surroundings from original tile are the same from the results intersection" << std::endl;
-            std::cout << "We can free all other tiles not in the intersection!" << std::endl;
-            for (auto &i : pivot_not_intersection) {
-                std::cout << "Revealing tile " << i[0]+1 << " " << i[1]+1 << std::endl;
-                warpAndClick(board, 46+25*(i[1]), 318+25*(i[0]), REVEAL_TILE, false);
+            *solver_log << "Pivoting taking place!" << std::endl;
+            *solver_log << "Surroundings from original tile are the same from the results intersection" << std::endl;
+            *solver_log << "We can free all other tiles not in the intersection!" << std::endl;
+            for (int i : pivot_not_intersection) {
+                *solver_log << "Revealing tile " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                arena.push(i, {board.row(i), board.col(i), REVEAL_TILE});
             }
             return true;
         }
@@ -533,11 +1913,11 @@ bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x
         // TODO: is this really a pivot scenario?
         if (pivot_expected_bombs == expected_bombs && results_not_intersection.size() == 0) {
             if (pivot_not_intersection.size() == 0) return false;
-            std::cout << "Pivoting taking place!" << std::endl;
-            std::cout << "The results not intersection size is 0, then let's reveal the pivots not intersections" << std::endl;
-            for (auto &i : pivot_not_intersection) {
-                std::cout << "Revealing tile " << i[0]+1 << " " << i[1]+1 << std::endl;
-                warpAndClick(board, 46+25*(i[1]), 318+25*(i[0]), REVEAL_TILE, false);
+            *solver_log << "Pivoting taking place!" << std::endl;
+            *solver_log << "The results not intersection size is 0, then let's reveal the pivots not intersections" << std::endl;
+            for (int i : pivot_not_intersection) {
+                *solver_log << "Revealing tile " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                arena.push(i, {board.row(i), board.col(i), REVEAL_TILE});
             }
             return true;
         }
@@ -547,12 +1927,12 @@ bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x
         // be marked as bombs.
         if (expected_bombs - pivot_expected_bombs == (int)results_not_intersection.size()) {
             if (results_not_intersection.size() == 0) return false;
-            std::cout << "Pivoting taking place!" << std::endl;
-            std::cout << "The NOT intersection size is the same amount of expected bombs difference, marking as bomb!" << std::endl;
-            for (auto &i : results_not_intersection) {
-                std::cout << "Marking bomb at " << i[0]+1 << " " << i[1]+1 << std::endl;
-                board.at(i[0]).at(i[1]) = 'M';
-                warpAndClick(board, 46+25*(i[1]), 318+25*(i[0]), MARK_BOMB, false);
+            *solver_log << "Pivoting taking place!" << std::endl;
+            *solver_log << "The NOT intersection size is the same amount of expected bombs difference, marking as bomb!" << std::endl;
+            for (int i : results_not_intersection) {
+                *solver_log << "Marking bomb at " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                board[i] = 'M';
+                arena.push(i, {board.row(i), board.col(i), MARK_BOMB});
             }
             return true;
         }
@@ -566,23 +1946,25 @@ bool pivotBoard(std::vector<std::vector<char>>& board, int x, int y, int pivot_x
  * @param board Board with the tiles freed, not-freed and bombs marked
  * @param x X coordinate of the board
  * @param y Y coordinate of the board
+ * @param arena Scratch memory of the current board run, where the moves decided are stored
  * @param strategy Strategy chosen for mark bombs or free tiles. The default one is SIMPLE.
  * @return returns true if a modification was done in the board, false if not
  */
-bool markBombs(std::vector<std::vector<char>>& board, int x, int y, STRATEGY strategy = SIMPLE) {
+template <typename BoardT>
+bool markBombs(BoardT& board, int x, int y, SolveArena& arena, STRATEGY strategy = SIMPLE) {
     // Converting the amount of bombs from char to int (Since this comes from ASCII table, just
     // subtracting it by 48)
-    int bombs = board.at(x).at(y)-48;
+    int bombs = board.at(x, y)-48;
     // bomb_counter will track how much bombs exist in the tile's neighborhood, and the possible locations
     // will be stored in results vector.
     int bomb_counter = 0;
-    std::vector<std::vector<int>> results;
-    std::vector<std::vector<int>> surroundings = surroundingTiles(board, x, y);
+    NeighbourList results;
+    NeighbourList surroundings = surroundingTiles(board, x, y);
     // Separate marked bombs from bomb-candidates
     if (surroundings.size() > 0) {
-        for (auto &i : surroundingTiles(board, x, y)) {
-            if (board.at(i[0]).at(i[1]) != 'M') {
-                results.emplace_back(i);
+        for (int i : surroundings) {
+            if (board[i] != 'M') {
+                results.push(i);
             } else {
                 bomb_counter++;
             }
@@ -591,62 +1973,68 @@ bool markBombs(std::vector<std::vector<char>>& board, int x, int y, STRATEGY str
 
     // Based on the strategy, mark bombs and/or free tiles.
     if (strategy == SIMPLE) {
-        std::cout << "Found a " << bombs << " tile in position " << x+1 << " " << y+1 << std::endl;
+        *solver_log << "Found a " << bombs << " tile in position " << x+1 << " " << y+1 << std::endl;
         // If bomb counter is the amount of bombs, then we already know the positions!
         if (bomb_counter == bombs ) {
-            std::cout << "Bomb counter is " << bombs << " in position " << x+1 << " " << y+1 << std::endl;
-            std::cout << "Revealing tile at " << x+1 << " " << y+1 << std::endl;
-            warpAndClick(board, 46+25*(y), 318+25*(x), REVEAL_TILE);
+            // Nothing left around it to be revealed
+            if (results.size() == 0) return false;
+            *solver_log << "Bomb counter is " << bombs << " in position " << x+1 << " " << y+1 << std::endl;
+            // Every other tile around it is free. The planner decides if they are revealed one by one, or
+            // all at once by chording this tile.
+            for (int i : results) {
+                *solver_log << "Revealing tile at " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                arena.push(i, {board.row(i), board.col(i), REVEAL_TILE});
+            }
             return true;
         } else if (bomb_counter + (int)results.size() == bombs) {
-            std::cout << "Bomb counter summed with results size is " << bombs << " in position " << x+1 << " " << y+1 << std::endl;
-            for (auto i : results) {
-                std::cout << "Marking bomb at " << i[0]+1 << " " << i[1]+1 << std::endl;
-                board.at(i[0]).at(i[1]) = 'M';
-                warpAndClick(board, 46+25*(i[1]), 318+25*(i[0]), MARK_BOMB);
+            *solver_log << "Bomb counter summed with results size is " << bombs << " in position " << x+1 << " " << y+1 << std::endl;
+            for (int i : results) {
+                *solver_log << "Marking bomb at " << board.row(i)+1 << " " << board.col(i)+1 << std::endl;
+                board[i] = 'M';
+                arena.push(i, {board.row(i), board.col(i), MARK_BOMB});
             }
             return true;
         } 
     } else if(strategy == PIVOT) {
         // Pivoting...
-        std::cout << "Valid pivot case! Trying pivoting at " << x+1 << " " << y+1 << std::endl;
+        *solver_log << "Valid pivot case! Trying pivoting at " << x+1 << " " << y+1 << std::endl;
         int pivot_x;
         int pivot_y;
         // There are 4 possible pivotings, left, right, up and down. However, we need to check
         // if the pivoting is possible, and valid.
         if (y > 0) {
             // left
-            std::cout << "Pivoting to the left" << std::endl;
+            *solver_log << "Pivoting to the left" << std::endl;
             pivot_x = x;
             pivot_y = y-1;
-            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter)) return true;
+            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter, arena)) return true;
         } 
         
-        if (y < (int)board[0].size()-1) {
+        if (y < board.cols()-1) {
             // right
-            std::cout << "Pivoting to the right" << std::endl;
+            *solver_log << "Pivoting to the right" << std::endl;
             pivot_x = x;
             pivot_y = y+1;
-            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter)) return true;
+            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter, arena)) return true;
         }
         
         if(x > 0) {
             // up
-            std::cout << "Pivoting up" << std::endl;
+            *solver_log << "Pivoting up" << std::endl;
             pivot_x = x-1;
             pivot_y = y;
-            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter)) return true;
+            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter, arena)) return true;
         } 
 
-        if(x < (int)board.size()-1) {
+        if(x < board.rows()-1) {
             // down
-            std::cout << "Pivoting down" << std::endl;
+            *solver_log << "Pivoting down" << std::endl;
             pivot_x = x+1;
             pivot_y = y;
-            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter)) return true;
+            if (pivotBoard(board, x, y, pivot_x, pivot_y, surroundings, results, bomb_counter, arena)) return true;
         } else {
             // That's a fallback in case none of the pivotings worked, but this is likely to be impossible.
-            std::cout << "Pivoting (somehow) needs enhancement..." << std::endl;
+            *solver_log << "Pivoting (somehow) needs enhancement..." << std::endl;
             return false;
         }
     }
@@ -654,62 +2042,1028 @@ bool markBombs(std::vector<std::vector<char>>& board, int x, int y, STRATEGY str
 }
 
 /**
- * That's the main function, where the program starts
- * @param argc Amount of arguments
- * @param argv Array with arguments
- * @return returns 0 when program finishes
+ * This function checks if a tile, or any tile around it, is touched by a move not yet seen on screen
+ * @param board Board the tile belongs to
+ * @param in_flight Tiles touched by moves not yet seen on screen
+ * @param cell Packed index of the tile
+ * @return returns true if the tile, or one of its neighbors, is in flight
  */
-int main (int argc, const char * argv[]) {
-    // Working with the first argument. It should be within a given range to choose the
-    // correct puzzle difficulty. Right now, only the following ones are supported:
-    // TABLE SIZES:
-    // BEGINNER     :  9x9
-    // INTERMEDIATE : 16x16
-    // EXPERT       : 16x30
+template <typename BoardT>
+bool touchesInFlight(const BoardT& board, const std::vector<char>& in_flight, int cell) {
+    if (in_flight[cell]) return true;
+    for (int i : board.neighbours(cell)) {
+        if (in_flight[i]) return true;
+    }
+    return false;
+}
 
-    // The offsets, and position in screen are all empiric and based on a monitor with:
-    // Height : 1080px
-    // Width : 3286px (2 monitors)
-    // Firefox browser with 80% zoom.
-    DIFFICULTY difficulty;
-    int board_size_x = 9;
-    int board_size_y = 9;
-    if (argc > 1) {
-        switch (atoi(argv[1])) {
-            case 0:
-                difficulty = BEGINNER;
-                break;
-            case 1:
-                difficulty = INTERMEDIATE;
-                board_size_x = 16;
-                board_size_y = 16;
-                break;
-            case 2:
-                difficulty = EXPERT;
-                board_size_x = 30;
-                board_size_y = 16;
-                break;
-            default:
-                difficulty = BEGINNER;
+/**
+ * This function marks the tiles a move will change as in flight
+ * @param in_flight Tiles touched by moves not yet seen on screen
+ * @param board Board used to know which tiles the move will change
+ * @param move Move to be marked
+ */
+template <typename BoardT>
+void markInFlight(std::vector<char>& in_flight, const BoardT& board, const Move& move) {
+    // The solver already knows about marked bombs, so only revealing matters here
+    if (move.action == MARK_BOMB) return;
+    in_flight[board.index(move.x, move.y)] = 1;
+    // Chording reveals all the undiscovered tiles around it
+    if (move.action == CHORD_TILE) {
+        for (int i : surroundingTiles(board, move.x, move.y, "E")) {
+            in_flight[i] = 1;
+        }
+    }
+}
+
+// Everything the action planner remembers between solver runs.
+struct Planner {
+    // When false, bombs are only tracked in the board and never marked on screen. Chording needs the
+    // bombs marked, so it's never used in this mode either.
+    bool flags = true;
+    // Bombs already marked on screen
+    std::vector<char> flagged;
+    // Tile where the pointer was left by the last move
+    int pointer_x = 0;
+    int pointer_y = 0;
+};
+
+/**
+ * This function checks if a tile holds a number of surrounding bombs
+ * @param tile Tile to be checked
+ * @return returns true if the tile is a number from 1 to 8, false if not
+ */
+bool isNumber(char tile) {
+    return tile >= '1' && tile <= '8';
+}
+
+/**
+ * This function turns the moves decided in a solver run into the cheapest set of clicks found.
+ * The free tiles around a numbered tile with all its bombs known can be revealed at once by chording it,
+ * which costs one click plus one for every bomb around it not yet marked on screen. Chords are chosen
+ * greedily, the one saving more clicks first, and the free tiles left are revealed one by one. Bombs are
+ * only marked on screen when a chord needs them. At the end, the moves are ordered so the pointer always
+ * goes to the closest one next.
+ * @param board Board the moves were decided from. Bombs are expected to be already set in it
+ * @param decided Moves decided by the solver
+ * @param planner Planner state
+ * @param in_flight Tiles touched by moves not yet seen on screen. Numbered tiles next to them aren't
+ * chorded. It's nullptr by default, meaning there are no such moves.
+ * @return returns the planned moves, in the order they should be performed
+ */
+template <typename BoardT>
+std::vector<Move> planMoves(BoardT& board, const std::vector<Move>& decided, Planner& planner, const std::vector<char>* in_flight = nullptr) {
+    if ((int)planner.flagged.size() != board.size()) planner.flagged.assign(board.size(), 0);
+
+    // Free tiles still waiting for a click
+    std::vector<char> free_tiles(board.size(), 0);
+    int free_count = 0;
+    for (auto &move : decided) {
+        int cell = board.index(move.x, move.y);
+        if (move.action == REVEAL_TILE && board[cell] == 'E' && !free_tiles[cell]) {
+            free_tiles[cell] = 1;
+            free_count++;
+        }
+    }
+
+    // Every unit is either a chord, preceded by the bombs it needs marked, or a single reveal
+    std::vector<std::vector<Move>> units;
+    while (planner.flags && free_count > 0) {
+        int best_saving = 0;
+        int best_x = -1;
+        int best_y = -1;
+        for (int i = 0; i < board.rows(); i++) {
+            for (int j = 0; j < board.cols(); j++) {
+                if (!isNumber(board.at(i, j))) continue;
+                if (in_flight != nullptr && touchesInFlight(board, *in_flight, board.index(i, j))) continue;
+                int bomb_counter = 0;
+                int unflagged = 0;
+                int gain = 0;
+                for (int n : surroundingTiles(board, i, j)) {
+                    if (board[n] == 'M') {
+                        bomb_counter++;
+                        if (!planner.flagged[n]) unflagged++;
+                    } else {
+                        gain++;
+                    }
+                }
+                // The chord only reveals anything if every bomb around the tile is known
+                if (bomb_counter != board.at(i, j)-48 || gain == 0) continue;
+                // Only worth it if the tiles it reveals would cost more clicks one by one
+                int saving = 0;
+                for (int n : surroundingTiles(board, i, j, "E")) {
+                    if (free_tiles[n]) saving++;
+                }
+                saving -= 1 + unflagged;
+                if (saving > best_saving) {
+                    best_saving = saving;
+                    best_x = i;
+                    best_y = j;
+                }
+            }
+        }
+        if (best_x < 0) break;
+
+        *solver_log << "Chording tile " << best_x+1 << " " << best_y+1 << " saves " << best_saving << " clicks" << std::endl;
+        std::vector<Move> unit;
+        for (int n : surroundingTiles(board, best_x, best_y)) {
+            if (board[n] == 'M') {
+                if (!planner.flagged[n]) {
+                    planner.flagged[n] = 1;
+                    unit.push_back({board.row(n), board.col(n), MARK_BOMB});
+                }
+            } else if (free_tiles[n]) {
+                free_tiles[n] = 0;
+                free_count--;
+            }
+        }
+        unit.push_back({best_x, best_y, CHORD_TILE});
+        units.push_back(unit);
+    }
+    for (int i = 0; i < board.size(); i++) {
+        if (free_tiles[i]) units.push_back({{board.row(i), board.col(i), REVEAL_TILE}});
+    }
+
+    // Nearest unit first, starting from where the pointer currently is
+    std::vector<Move> planned;
+    std::vector<char> done(units.size(), 0);
+    for (size_t n = 0; n < units.size(); n++) {
+        int best = -1;
+        int best_distance = 0;
+        for (size_t u = 0; u < units.size(); u++) {
+            if (done[u]) continue;
+            int dx = units[u][0].x - planner.pointer_x;
+            int dy = units[u][0].y - planner.pointer_y;
+            if (best < 0 || dx*dx + dy*dy < best_distance) {
+                best = u;
+                best_distance = dx*dx + dy*dy;
+            }
+        }
+        done[best] = 1;
+        for (auto &move : units[best]) {
+            planned.push_back(move);
+            planner.pointer_x = move.x;
+            planner.pointer_y = move.y;
+        }
+    }
+
+    int revealed = 0;
+    for (auto &move : decided) {
+        if (move.action == REVEAL_TILE) revealed++;
+    }
+    if (planned.size() > 0) *solver_log << "Planned " << planned.size() << " clicks for " << revealed << " free tiles" << std::endl;
+    return planned;
+}
+
+/**
+ * This function decides what to do on a board where not even pivoting changed anything. The mine
+ * probabilities are brought up to date, tiles which are certainly free or bombs are taken, and when
+ * there are none, the tile least likely to be a bomb is revealed.
+ * @param board Board to be solved
+ * @param state Solver state kept between board runs. The moves decided are added to its arena.
+ * @return returns true if a move was decided, false if there are no undiscovered tiles left
+ */
+template <typename BoardT>
+bool resolveStalled(BoardT& board, SolverState& state) {
+    state.probabilities.update(board, state.mines);
+    int certain = 0;
+    int best = -1;
+    for (int cell = 0; cell < board.size(); cell++) {
+        if (board[cell] != 'E' || state.arena.decided[cell]) continue;
+        double probability = state.probabilities.at(cell);
+        if (state.probabilities.sure(cell) && probability == 0) {
+            *solver_log << "Tile at " << board.row(cell)+1 << " " << board.col(cell)+1 << " can't be a bomb, revealing it" << std::endl;
+            state.arena.push(cell, {board.row(cell), board.col(cell), REVEAL_TILE});
+            certain++;
+        } else if (state.probabilities.sure(cell) && probability == 1) {
+            *solver_log << "Tile at " << board.row(cell)+1 << " " << board.col(cell)+1 << " must be a bomb, marking it" << std::endl;
+            board[cell] = 'M';
+            state.arena.push(cell, {board.row(cell), board.col(cell), MARK_BOMB});
+            certain++;
+        } else if (best < 0 || probability < state.probabilities.at(best)) {
+            best = cell;
+        }
+    }
+    if (!certain) {
+        if (best < 0) return false;
+        *solver_log << "Guessing tile at " << board.row(best)+1 << " " << board.col(best)+1 << ", a bomb with probability " << state.probabilities.at(best) << std::endl;
+        state.arena.push(best, {board.row(best), board.col(best), REVEAL_TILE});
+    }
+    // There's something new on the board, so the SIMPLE strategy is tried again
+    std::fill(state.pivots_visited.begin(), state.pivots_visited.end(), 0);
+    state.board_stalled = false;
+    return true;
+}
+
+/**
+ * This function runs once through the whole board, trying to mark bombs or free tiles from every
+ * numbered tile. The moves decided are left in the solver state's arena, which is reset at the
+ * beginning of the run. The run itself doesn't allocate any memory.
+ * @param board Board to be solved
+ * @param state Solver state kept between board runs
+ * @param in_flight Tiles touched by moves not yet seen on screen. Tiles next to them are skipped in
+ * this run. It's nullptr by default, meaning there are no such moves.
+ * @return returns the amount of tiles that led to a board modification
+ */
+template <typename BoardT>
+int solvePass(BoardT& board, SolverState& state, const std::vector<char>* in_flight = nullptr) {
+    int board_changes = 0;
+    state.arena.reset();
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) {
+            int cell = board.index(i, j);
+            // No need to check tiles undiscovered (E), empty (0) or with bombs marked (M)
+            if (board[cell] != 'E' && board[cell] != '0' && board[cell] != 'M') {
+                // Do not check tiles whieh are inside the visited-array
+                if (!state.visited[cell] || (state.board_stalled && !state.pivots_visited[cell])) {
+                    // The screen isn't up to date around this tile yet, leave it for a later run
+                    if (in_flight != nullptr && touchesInFlight(board, *in_flight, cell)) continue;
+                    // Let's try to mark some bombs, or free tiles
+                    STRATEGY strategy = state.board_stalled ? PIVOT : SIMPLE;
+                    if (markBombs(board, i, j, state.arena, strategy)) {
+                        // In case the board was updated, then check if the tile is no-longer needed,
+                        // and if so, add it to visited-array
+                        if (strategy == SIMPLE) {
+                            int after_marking = surroundingTiles(board, i, j, "E").size();
+                            *solver_log << "After checking/marking position " << i+1 << " " << j+1 << " the amount of E's is: " << after_marking << std::endl;
+                            if (after_marking == 0) state.visited[cell] = 1;
+                        } else if (strategy == PIVOT) {
+                            // Pivoting worked! Let's empty the list, because it can led to other
+                            // pivots to work now. Moreover, the board is no longer stalled (at least in first glance).
+                            std::fill(state.pivots_visited.begin(), state.pivots_visited.end(), 0);
+                            *solver_log << "Emptying the pivots_visited vector" << std::endl;
+                            state.board_stalled = false;
+                        }
+                        board_changes++;
+                    } else {
+                        if (strategy == SIMPLE) {
+                            // Nothing else will ever happen around a tile without undiscovered neighbors
+                            if (surroundingTiles(board, i, j, "E").size() == 0) state.visited[cell] = 1;
+                        } else if (strategy == PIVOT) {
+                            // Pivoting failed. Add it to the visited list.
+                            state.pivots_visited[cell] = 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return board_changes;
+}
+
+/**
+ * This function does a board run, switching to the PIVOT strategy when the SIMPLE one changes nothing,
+ * and to the mine probabilities when not even pivoting does. Moves still on their way to the screen
+ * might change the board, so the strategy only changes once there are none.
+ * @param board Board to be solved
+ * @param state Solver state kept between board runs
+ * @param in_flight Tiles touched by moves not yet seen on screen. It's nullptr by default, meaning there
+ * are no such moves.
+ * @return returns false when there's nothing left to decide on the board, true otherwise
+ */
+template <typename BoardT>
+bool solveRun(BoardT& board, SolverState& state, const std::vector<char>* in_flight = nullptr) {
+    if (solvePass(board, state, in_flight) > 0) return true;
+    if (in_flight != nullptr && std::find(in_flight->begin(), in_flight->end(), 1) != in_flight->end()) return true;
+    if (!state.board_stalled) {
+        // Throughout an entire board run, nothing was changed with the SIMPLE strategy.
+        // Let's switch to the PIVOT one.
+        state.board_stalled = true;
+        return true;
+    }
+    // Not even pivoting changed anything, the mine probabilities decide
+    return resolveStalled(board, state);
+}
+
+// A board run done ahead of time, for one outcome of the tiles a batch of moves reveals
+template <typename BoardT>
+struct Speculation {
+    // Board as it's assumed to be once the batch is seen on screen
+    BoardT assumed;
+    // Board and solver state after the run
+    BoardT board;
+    SolverState state;
+    // Whether there was anything left to decide
+    bool going = true;
+    // What the run decided, logged once it's taken
+    std::ostringstream log;
+    // Set by the thread doing the run, so it's done only once
+    std::atomic<bool> claimed{false};
+    // Set once the run is over, under the batch's mutex
+    bool done = false;
+};
+
+// Runs for every outcome of one batch of moves. The workers keep the batch alive, so it can be abandoned
+// while some of its runs are still going.
+template <typename BoardT>
+struct SpeculationBatch {
+    // Solver state the runs start from. Every run copies it on its own thread.
+    SolverState state;
+    std::deque<Speculation<BoardT>> runs;
+    // Next run to be taken by a worker
+    std::atomic<std::size_t> next{0};
+    // Set once the batch is taken or abandoned. Workers don't start any other run then.
+    std::atomic<bool> cancelled{false};
+    // Workers still busy with the batch
+    std::atomic<int> working{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+/**
+ * Solves the board ahead of time while a batch of moves is performed and the screen is read again. Every
+ * possible number on the tiles the batch reveals gets its own board run, spread over the spare cores.
+ * Once the board is parsed, the run that assumed exactly that board is taken: only that one is waited for,
+ * or done right away if no worker got to it yet, and the others are abandoned. A blank tile opening up
+ * other ones can't be guessed, a normal run is needed then.
+ */
+template <typename BoardT>
+class Speculator {
+public:
+    // Largest amount of tiles revealed by a batch to speculate on. Every tile multiplies the runs by up to 9.
+    static constexpr int MAX_REVEALS = 2;
+    // Batches speculated on, and how many of them had the run ready
+    int speculated = 0;
+    int hits = 0;
+
+    ~Speculator() {
+        abandon();
+        for (auto &worker : workers) worker.second.join();
+    }
+
+    /**
+     * Starts the runs for a batch of moves, planned from the board given
+     * @param board Board the batch was planned on
+     * @param state Solver state after the run the batch comes from
+     * @param planned Moves of the batch. Batches with chords, or revealing too many tiles, aren't speculated on
+     */
+    void start(const BoardT& board, const SolverState& state, const std::vector<Move>& planned) {
+        abandon();
+        reap();
+        std::vector<int> cells;
+        for (auto &move : planned) {
+            if (move.action == CHORD_TILE) return;
+            if (move.action == REVEAL_TILE) cells.push_back(board.index(move.x, move.y));
+        }
+        if (cells.size() == 0 || cells.size() > MAX_REVEALS) return;
+        // The current thread is busy with the moves, only the other cores take the runs
+        int cores = std::thread::hardware_concurrency();
+        if (cores < 2) return;
+
+        // Numbers a tile can show: at least the bombs already marked around it, at most those plus every
+        // undiscovered tile around it not revealed by the batch. A blank with undiscovered tiles around
+        // opens them up too, so it's left out.
+        std::vector<std::vector<char>> outcomes(cells.size());
+        for (std::size_t k = 0; k < cells.size(); k++) {
+            int bombs = 0;
+            int maybe = 0;
+            board.forEachNeighbour(cells[k], [&](int i) {
+                if (board[i] == 'M') bombs++;
+                else if (board[i] == 'E' && std::find(cells.begin(), cells.end(), i) == cells.end()) maybe++;
+            });
+            for (int number = bombs; number <= bombs + maybe; number++) {
+                if (number > 0 || maybe == 0) outcomes[k].push_back((char)(48+number));
+            }
+        }
+        // Every combination of outcomes
+        batch = std::make_shared<SpeculationBatch<BoardT>>();
+        batch->state = state;
+        std::vector<std::size_t> pick(cells.size(), 0);
+        while (true) {
+            batch->runs.emplace_back();
+            Speculation<BoardT>& run = batch->runs.back();
+            run.assumed = board;
+            for (std::size_t k = 0; k < cells.size(); k++) run.assumed[cells[k]] = outcomes[k][pick[k]];
+            std::size_t k = 0;
+            while (k < cells.size() && ++pick[k] == outcomes[k].size()) pick[k++] = 0;
+            if (k == cells.size()) break;
+        }
+        speculated++;
+
+        std::size_t amount = std::min<std::size_t>(cores - 1, batch->runs.size());
+        batch->working = amount;
+        for (std::size_t w = 0; w < amount; w++) {
+            workers.emplace_back(batch, std::thread([current = batch] {
+                for (std::size_t r = current->next++; r < current->runs.size() && !current->cancelled; r = current->next++) {
+                    Speculation<BoardT>& run = current->runs[r];
+                    if (run.claimed.exchange(true)) continue;
+                    solver_log = &run.log;
+                    run.board = run.assumed;
+                    run.state = current->state;
+                    run.going = solveRun(run.board, run.state);
+                    std::lock_guard<std::mutex> lock(current->mutex);
+                    run.done = true;
+                    current->finished.notify_all();
+                }
+                current->working--;
+            }));
+        }
+    }
+
+    /**
+     * Takes the run matching the board parsed after the batch, if there's one. The other runs are abandoned.
+     * @param board Board parsed after the batch. It's replaced by the board after the run
+     * @param state Solver state, replaced by the one after the run
+     * @param going Whether there was anything left to decide in the run
+     * @return returns true if a run matched the board, false if a normal run is needed
+     */
+    bool take(BoardT& board, SolverState& state, bool& going) {
+        std::shared_ptr<SpeculationBatch<BoardT>> current = batch;
+        abandon();
+        if (current == nullptr) return false;
+        for (auto &run : current->runs) {
+            bool same = true;
+            for (int i = 0; i < board.size() && same; i++) same = run.assumed[i] == board[i];
+            if (!same) continue;
+            if (!run.claimed.exchange(true)) {
+                // No worker got to it yet, so it's done right here
+                run.board = run.assumed;
+                run.state = current->state;
+                run.going = solveRun(run.board, run.state);
+            } else {
+                std::unique_lock<std::mutex> lock(current->mutex);
+                current->finished.wait(lock, [&] { return run.done; });
+                *solver_log << run.log.str();
+            }
+            std::swap(board, run.board);
+            std::swap(state, run.state);
+            going = run.going;
+            hits++;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::shared_ptr<SpeculationBatch<BoardT>> batch;
+    // Every worker started, with the batch it works on
+    std::vector<std::pair<std::shared_ptr<SpeculationBatch<BoardT>>, std::thread>> workers;
+
+    // Lets the workers of the current batch stop after the run they're on
+    void abandon() {
+        if (batch != nullptr) batch->cancelled = true;
+        batch = nullptr;
+    }
+
+    // Joins the workers of batches no longer worked on, which returns right away
+    void reap() {
+        for (std::size_t w = 0; w < workers.size();) {
+            if (workers[w].first->working > 0) {
+                w++;
+                continue;
+            }
+            workers[w].second.join();
+            workers.erase(workers.begin() + w);
+        }
+    }
+};
+
+/**
+ * This function does a board run and plans the moves it decided. When a speculator is given, the run it
+ * did ahead of time for this board is taken instead, and the run after this one is started.
+ * @param board Board to be solved
+ * @param state Solver state kept between board runs
+ * @param planner Planner state
+ * @param planned Moves planned, in the order they should be performed
+ * @param in_flight Tiles touched by moves not yet seen on screen. It's nullptr by default
+ * @param speculator Speculator solving ahead of time, if any. It's nullptr by default
+ * @return returns false when there's nothing left to decide on the board, true otherwise
+ */
+template <typename BoardT>
+bool planRun(BoardT& board, SolverState& state, Planner& planner, std::vector<Move>& planned, const std::vector<char>* in_flight = nullptr, Speculator<BoardT>* speculator = nullptr) {
+    bool going = true;
+    if (speculator != nullptr && speculator->take(board, state, going)) {
+        *solver_log << "Board run was ready ahead of time" << std::endl;
+    } else {
+#ifdef COUNT_ALLOCATIONS
+        std::size_t allocations = allocation_counter;
+#endif
+        going = solveRun(board, state, in_flight);
+#ifdef COUNT_ALLOCATIONS
+        *solver_log << "Board run allocated " << allocation_counter - allocations << " times" << std::endl;
+#endif
+    }
+    planned = planMoves(board, state.arena.moves, planner, in_flight);
+    // The next run is done while the moves are performed and the screen is read again
+    if (speculator != nullptr && going) speculator->start(board, state, planned);
+    return going;
+}
+
+// Batches in a row that can leave every tile as it was before a game is given up as unfinished. When a click
+// misses, or the tile it reveals is read with too little confidence, the screen keeps showing the tile as
+// undiscovered and the same move would be planned forever.
+constexpr int MAX_IDLE_BATCHES = 5;
+
+/**
+ * This function counts the undiscovered tiles (E) of a board. Every batch of moves that isn't idle lowers it.
+ * @param board Board to be checked
+ * @return returns the amount of undiscovered tiles
+ */
+template <typename BoardT>
+int countUndiscovered(const BoardT& board) {
+    int undiscovered = 0;
+    for (int i = 0; i < board.size(); i++) {
+        if (board[i] == 'E') undiscovered++;
+    }
+    return undiscovered;
+}
+
+/**
+ * This function plays a game until it's over, until nothing is left to decide on the board, or until
+ * MAX_IDLE_BATCHES batches in a row discover nothing
+ * @param board Board to be solved, already parsed
+ * @param state Solver state kept between board runs
+ * @param planner Planner state
+ * @param perform Performs a batch of moves and reads the board again, returning the GAME_STATE after it
+ * @param speculator Speculator solving ahead of time, if any. It's nullptr by default
+ * @return returns the GAME_STATE at the end. IN_PROGRESS means the game was given up
+ */
+template <typename BoardT, typename Perform>
+GAME_STATE solveGame(BoardT& board, SolverState& state, Planner& planner, Perform&& perform, Speculator<BoardT>* speculator = nullptr) {
+    GAME_STATE result = IN_PROGRESS;
+    std::vector<Move> planned;
+    // Batches in a row where neither the run nor the screen discovered any tile
+    int idle = 0;
+    while (result == IN_PROGRESS) {
+        int undiscovered = countUndiscovered(board);
+        if (!planRun(board, state, planner, planned, nullptr, speculator)) break;
+        result = perform(planned);
+        idle = countUndiscovered(board) < undiscovered ? 0 : idle+1;
+        if (idle == MAX_IDLE_BATCHES) {
+            *solver_log << "Nothing was discovered in " << MAX_IDLE_BATCHES << " batches, giving the game up" << std::endl;
+            break;
+        }
+    }
+    return result;
+}
+
+// A screenshot handed from the capture stage to the recognition stage
+struct Frame {
+    std::vector<std::uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    int bpp = 0;
+    // Amount of moves already performed when the screenshot was requested
+    std::uint64_t epoch = 0;
+};
+
+// A parsed board handed from the recognition stage to the solver stage
+template <typename BoardT>
+struct BoardSnapshot {
+    BoardT board;
+    std::uint64_t epoch = 0;
+    // The smiling face changed, so the game is over. How it ended is told from the solver's board.
+    bool face_changed = false;
+};
+
+/**
+ * This function solves the board with capture, recognition, solving and actions running at the same time,
+ * each stage on its own thread and connected to the next one by a bounded queue. While a batch of moves is
+ * being performed, the next screenshots are already being taken and parsed, and the solver keeps working on
+ * the tiles these moves don't touch.
+ * @param board Board to be solved
+ * @param state Solver state kept between board runs
+ * @param planner Planner state
+ * @param theme Theme with the glyph signatures of the game, if any. It's nullptr by default
+ * @param watch Game to be checked for its end, if any. Solving stops as soon as it's over. It's nullptr by default
+ */
+template <typename BoardT>
+void solvePipelined(BoardT& board, SolverState& state, Planner& planner, const Theme* theme = nullptr, GameWatch* watch = nullptr) {
+    std::atomic<std::uint64_t> moves_done(0);
+    std::atomic<bool> stop(false);
+    BoundedQueue<Frame> frames(2);
+    BoundedQueue<BoardSnapshot<BoardT>> snapshots(2);
+    BoundedQueue<std::vector<Move>> batches(8);
+
+    // Capture stage
+    std::thread capture([&] {
+        while (!stop) {
+            Frame frame;
+            frame.epoch = moves_done;
+            // Give the original game time to update the tiles accordingly, so every move counted in the
+            // epoch is already drawn when the screenshot is taken
+            usleep(80000);
+            ImageFromDisplay(frame.pixels, frame.width, frame.height, frame.bpp);
+            if (!frames.push(std::move(frame))) break;
+        }
+    });
+
+    // Recognition stage. It keeps its own copy of the board, so tiles already known aren't parsed again,
+    // and of the game watch. Its board never gets the bombs marked by the solver, so it only reads the face.
+    GameWatch watching = watch != nullptr ? *watch : GameWatch();
+    std::thread recognize([&, recognized = board]() mutable {
+        Frame frame;
+        while (frames.pop(frame)) {
+            Mat img = Mat(frame.height, frame.width, frame.bpp > 24 ? CV_8UC4 : CV_8UC3, &frame.pixels[0]);
+            parseBoard(img, recognized, false, BoardOrigin(), theme);
+            bool face_changed = watch != nullptr && faceChanged(img, recognized.cols(), watching);
+            if (!snapshots.push({recognized, frame.epoch, face_changed})) break;
+        }
+    });
+
+    // Action stage
+    std::thread act([&] {
+        std::vector<Move> batch;
+        while (batches.pop(batch)) {
+            for (auto &move : batch) {
+                clickAt(46+25*(move.y), 318+25*(move.x), move.action);
+                moves_done++;
+            }
+        }
+    });
+
+    // Solver stage, in the current thread. Moves are numbered in the order they are performed, so a
+    // snapshot shows every move up to its epoch.
+    std::deque<std::pair<std::uint64_t, Move>> pending;
+    std::uint64_t moves_issued = 0;
+    std::vector<char> in_flight(board.size(), 0);
+    auto enqueue = [&](std::vector<Move>& moves) {
+        for (auto &move : moves) {
+            pending.push_back({++moves_issued, move});
+            markInFlight(in_flight, board, move);
+        }
+        batches.push(moves);
+    };
+
+    BoardSnapshot<BoardT> snapshot;
+    std::vector<Move> planned;
+    // Undiscovered tiles before the moves still pending were planned, -1 when there are none. Once they are
+    // all on screen, the batches are idle if nothing was discovered since.
+    int planned_from = -1;
+    int idle = 0;
+    while (snapshots.pop(snapshot)) {
+        // Take the newly discovered tiles. Bombs marked by the solver are kept, since the recognition
+        // doesn't know about them.
+        for (int i = 0; i < board.size(); i++) {
+            if (board[i] == 'E') board[i] = snapshot.board[i];
+        }
+        GAME_STATE game = watch != nullptr ? gameState(board, watch->mines, snapshot.face_changed) : IN_PROGRESS;
+        if (game != IN_PROGRESS) {
+            // The game is over, the moves still waiting are dropped
+            watch->state = game;
+            batches.clear();
+            break;
+        }
+
+        // Forget the moves this snapshot already shows, and rebuild the in flight tiles from the others
+        while (!pending.empty() && pending.front().first <= snapshot.epoch) pending.pop_front();
+        std::fill(in_flight.begin(), in_flight.end(), 0);
+        for (auto &move : pending) markInFlight(in_flight, board, move.second);
+
+        int undiscovered = countUndiscovered(board);
+        if (pending.empty() && planned_from >= 0) {
+            idle = undiscovered < planned_from ? 0 : idle+1;
+            planned_from = -1;
+            if (idle == MAX_IDLE_BATCHES) {
+                *solver_log << "Nothing was discovered in " << MAX_IDLE_BATCHES << " batches, giving the game up" << std::endl;
                 break;
+            }
+        }
+
+        bool going = planRun(board, state, planner, planned, &in_flight);
+        if (planned.size() > 0) {
+            if (planned_from < 0) planned_from = undiscovered;
+            enqueue(planned);
+        }
+        // Nothing is left to decide, and nothing is on its way to the screen
+        if (!going && pending.empty()) break;
+    }
+
+    // Let the moves already decided finish before stopping the screenshots
+    batches.close();
+    act.join();
+    stop = true;
+    frames.close();
+    snapshots.close();
+    capture.join();
+    recognize.join();
+}
+
+// Options given on the command line
+struct Options {
+    // Run capture, recognition, solving and actions at the same time
+    bool pipelined = false;
+    // Mark bombs on screen when needed. Otherwise they're only tracked in the board
+    bool flags = true;
+    // Find every board with the difficulty's size on the screen, and solve them all
+    bool find_boards = false;
+    // Origins of boards given by hand, solved along with the ones found
+    std::vector<BoardOrigin> origins;
+    // Glyph signatures of the game. Tiles are read with them once the theme is ready
+    Theme theme;
+    // Theme file to learn from the screen, and file with the actual tiles on the screen
+    std::string learn_path;
+    std::string labels_path;
+    // Amount of bombs of the board, to tell a win apart
+    int mines = 0;
+    // Amount of games to be played. When it's 0, one game on every board, or as many as fit in the minutes
+    int games = 0;
+    // Play new games until this much time has passed. When it's 0, there's no time limit
+    double minutes = 0;
+    // Solve ahead of time for every outcome of the tiles being revealed
+    bool speculate = false;
+};
+
+// Results of the games played in a run of the program
+struct Session {
+    int games = 0;
+    int won = 0;
+    int lost = 0;
+    // Games given up after every board run, neither won nor lost
+    int unfinished = 0;
+    double seconds = 0;
+    double fastest_win = 0;
+
+    /**
+     * Adds the result of a game to the session
+     * @param result How the game ended
+     * @param game_seconds How long the game took
+     */
+    void record(GAME_STATE result, double game_seconds) {
+        games++;
+        seconds += game_seconds;
+        if (result == WON) {
+            won++;
+            if (fastest_win == 0 || game_seconds < fastest_win) fastest_win = game_seconds;
+        } else if (result == LOST) {
+            lost++;
+        } else {
+            unfinished++;
         }
+    }
+
+    /**
+     * Prints the session statistics
+     * @param elapsed How long the whole session took, in seconds
+     */
+    void print(double elapsed) const {
+        printf("Session: %d games in %.1fs, %d won (%.0f%%), %d lost, %d unfinished\n", games, elapsed, won, games ? 100.0*won/games : 0.0, lost, unfinished);
+        if (games) printf("Session: %.1fs per game, fastest win %.1fs\n", seconds/games, fastest_win);
+    }
+};
+
+// Name of every GAME_STATE for the logs
+const char* const GAME_STATE_NAMES[] = {"UNFINISHED", "WON", "LOST"};
+
+/**
+ * This function tells if another game should be started
+ * @param options Command line options
+ * @param started Amount of games already started
+ * @param boards Amount of boards being played
+ * @param elapsed Time since the session started, in seconds
+ * @return returns true if another game should be started
+ */
+bool keepPlaying(const Options& options, int started, int boards, double elapsed) {
+    if (options.minutes > 0 && elapsed >= options.minutes*60) return false;
+    if (options.games > 0) return started < options.games;
+    return options.minutes > 0 || started < boards;
+}
+
+// A game on the screen, solved along with others when there are many boards
+template <typename BoardT>
+struct BoardInstance {
+    BoardT board;
+    BoardOrigin origin;
+    SolverState state;
+    Planner planner;
+    GameWatch watch;
+    // Nothing is left to decide on the board, or nothing was discovered in MAX_IDLE_BATCHES batches in a row,
+    // so the game is given up
+    bool stuck = false;
+    // Undiscovered tiles before the last run, -1 before the first one
+    int undiscovered = -1;
+    int idle = 0;
+    // The game was restarted, and waits for its first click
+    bool starting = false;
+    bool done = false;
+    std::chrono::steady_clock::time_point first_click_at;
+    std::chrono::steady_clock::time_point started_at;
+    // The board isn't parsed again before the game has redrawn the tiles revealed by its last moves
+    std::chrono::steady_clock::time_point redrawn_at;
+};
+
+/**
+ * This function plays games on every board of the screen at once. Every board keeps its own state and
+ * solver, but they all share one connection to the X server and one screenshot per round. A board waiting
+ * for the game to redraw its tiles, or to restart, is skipped, so it never holds back the boards that are
+ * ready. Once a game is over, the board gets a new one while the session goes on.
+ * @param empty Board with every tile undiscovered, copied for every game
+ * @param options Command line options
+ * @return returns 0 when every game was won, 1 otherwise or if no board was found
+ */
+template <typename BoardT>
+int playBoards(const BoardT& empty, const Options& options) {
+    typedef std::chrono::steady_clock Clock;
+    int Width = 0;
+    int Height = 0;
+    int Bpp = 0;
+    std::vector<std::uint8_t> Pixels;
+    // Every screenshot and click goes through this connection
+    Display* display = XOpenDisplay(nullptr);
+    if (display == nullptr) {
+        fprintf(stderr, "Couldn't open the display\n");
+        return 1;
+    }
+
+    std::vector<BoardOrigin> origins = options.origins;
+    if (options.find_boards) {
+        ImageFromDisplay(Pixels, Width, Height, Bpp, display);
+        Mat img = Mat(Height, Width, Bpp > 24 ? CV_8UC4 : CV_8UC3, &Pixels[0]);
+        std::vector<BoardOrigin> found = locateBoards(img, empty.rows(), empty.cols());
+        origins.insert(origins.end(), found.begin(), found.end());
+    }
+    if (origins.size() == 0) {
+        fprintf(stderr, "No board found on the screen\n");
+        XCloseDisplay(display);
+        return 1;
+    }
+    std::cout << "Playing " << origins.size() << " boards" << std::endl;
+
+    Session session;
+    int started = 0;
+    Clock::time_point session_start = Clock::now();
+    auto elapsed = [&] { return std::chrono::duration<double>(Clock::now() - session_start).count(); };
+    // Restart a game by clicking on its smiling face. The first click comes once the game had time to restart.
+    auto restart = [&](BoardInstance<BoardT>& instance) {
+        pressAt(150+(empty.cols()-9)*12.666 + instance.origin.x, 265 + instance.origin.y, display);
+        instance.starting = true;
+        instance.first_click_at = Clock::now() + std::chrono::seconds(1);
+        started++;
+    };
+
+    std::vector<BoardInstance<BoardT>> instances(origins.size());
+    for (std::size_t k = 0; k < origins.size(); k++) {
+        instances[k].origin = origins[k];
+        if (keepPlaying(options, started, origins.size(), elapsed())) restart(instances[k]);
+        else instances[k].done = true;
+    }
+
+    const Theme* theme = options.theme.ready ? &options.theme : nullptr;
+    std::vector<Move> planned;
+    while (true) {
+        // Wait for the first board to be ready. Boards not waiting for anything are ready right away.
+        Clock::time_point next = Clock::time_point::max();
+        for (auto &instance : instances) {
+            if (!instance.done) next = std::min(next, instance.starting ? instance.first_click_at : instance.redrawn_at);
+        }
+        if (next == Clock::time_point::max()) break;
+        std::this_thread::sleep_until(next);
+
+        for (auto &instance : instances) {
+            if (instance.done || !instance.starting || instance.first_click_at > Clock::now()) continue;
+            // Force first click to start a new game. The pointer is left at this tile.
+            pressAt(100 + instance.origin.x, 345 + instance.origin.y, display);
+            instance.board = empty;
+            instance.state = SolverState(empty.size());
+            instance.state.mines = options.mines;
+            instance.planner = Planner();
+            instance.planner.flags = options.flags;
+            instance.planner.pointer_x = 1;
+            instance.planner.pointer_y = 2;
+            instance.watch = GameWatch();
+            instance.watch.mines = options.mines;
+            instance.watch.origin = instance.origin;
+            instance.stuck = false;
+            instance.undiscovered = -1;
+            instance.idle = 0;
+            instance.starting = false;
+            instance.started_at = Clock::now();
+            // Wait the game to be generated and started
+            instance.redrawn_at = instance.started_at + std::chrono::seconds(2);
+        }
+
+        // One screenshot for every board ready
+        Clock::time_point captured_at = Clock::now();
+        ImageFromDisplay(Pixels, Width, Height, Bpp, display);
+        Mat img = Mat(Height, Width, Bpp > 24 ? CV_8UC4 : CV_8UC3, &Pixels[0]);
+        for (auto &instance : instances) {
+            if (instance.done || instance.starting || instance.redrawn_at > captured_at) continue;
+            parseBoard(img, instance.board, false, instance.origin, theme);
+            // The face is read on the first screenshot of the game, while it's in progress
+            if (instance.watch.smiley.size() == 0) instance.watch.smiley = readSmiley(img, empty.cols(), instance.origin);
+            int undiscovered = countUndiscovered(instance.board);
+            if (instance.undiscovered >= 0) {
+                instance.idle = undiscovered < instance.undiscovered ? 0 : instance.idle+1;
+                if (instance.idle == MAX_IDLE_BATCHES) instance.stuck = true;
+            }
+            instance.undiscovered = undiscovered;
+            if (watchGame(img, instance.board, instance.watch) != IN_PROGRESS || instance.stuck) {
+                double seconds = std::chrono::duration<double>(Clock::now() - instance.started_at).count();
+                session.record(instance.watch.state, seconds);
+                printf("Game %d at %i,%i: %s in %.1fs\n", session.games, instance.origin.x, instance.origin.y, GAME_STATE_NAMES[instance.watch.state], seconds);
+                printBoard(instance.board);
+                if (keepPlaying(options, started, instances.size(), elapsed())) restart(instance);
+                else instance.done = true;
+                continue;
+            }
+
+            instance.stuck = !planRun(instance.board, instance.state, instance.planner, planned);
+            bool revealed = false;
+            for (auto &move : planned) {
+                clickAt(46+25*(move.y), 318+25*(move.x), move.action, false, instance.origin, display);
+                if (move.action != MARK_BOMB) revealed = true;
+            }
+            // Give the original game time to update the tiles accordingly
+            if (revealed) instance.redrawn_at = Clock::now() + std::chrono::milliseconds(80);
+        }
+    }
+
+    XCloseDisplay(display);
+    session.print(elapsed());
+    // Only a session where every game was won is a success
+    return session.games > 0 && session.won == session.games ? 0 : 1;
+}
+
+/**
+ * This function learns the glyph signatures of the game's theme from the board on the screen, and saves
+ * them. The tiles are told by a labels file, with one line of tiles for every row as printBoard() shows
+ * them ('F' for a flag, '*' for a mine and 'X' for the exploded one). Without it, the pixel-average
+ * recognition tells the tiles it's sure about: undiscovered, blank and numbers up to 6.
+ * @param board Board with the size of the one on the screen
+ * @param options Command line options. The first --board origin is used, if any
+ * @return returns 0 when the theme is saved, 1 otherwise
+ */
+template <typename BoardT>
+int learnFromScreen(BoardT& board, const Options& options) {
+    int Width = 0;
+    int Height = 0;
+    int Bpp = 0;
+    std::vector<std::uint8_t> Pixels;
+    BoardOrigin origin = options.origins.size() > 0 ? options.origins[0] : BoardOrigin();
+    ImageFromDisplay(Pixels, Width, Height, Bpp);
+    Mat img = Mat(Height, Width, Bpp > 24 ? CV_8UC4 : CV_8UC3, &Pixels[0]);
+
+    if (options.labels_path.size() > 0) {
+        FILE* file = fopen(options.labels_path.c_str(), "r");
+        if (file == NULL) {
+            fprintf(stderr, "Couldn't read %s\n", options.labels_path.c_str());
+            return 1;
+        }
+        // Spaces between tiles are skipped
+        int i = 0;
+        int j = 0;
+        for (int c = fgetc(file); c != EOF && i < board.rows(); c = fgetc(file)) {
+            if (c == '\n') {
+                if (j > 0) i++;
+                j = 0;
+            } else if (c != ' ' && j < board.cols()) {
+                board.at(i, j++) = (char)c;
+            }
+        }
+        fclose(file);
     } else {
-        difficulty = BEGINNER;
+        parseBoard(img, board, false, origin);
+        for (int i = 0; i < board.rows(); i++) {
+            for (int j = 0; j < board.cols(); j++) {
+                if (!strchr("E0123456", board.at(i, j))) board.at(i, j) = '9';
+            }
+        }
     }
-    std::cout << "Difficulty is: " << difficulty << std::endl;
+    std::cout << "Tiles on the screen:" << std::endl;
+    printBoard(board);
+
+    ThemeSamples samples;
+    collectSamples(img, board, origin, samples);
+    // A theme already saved keeps its points, only the states on the screen are learned again
+    Theme theme = options.theme;
+    if (!learnTheme(samples, theme)) {
+        fprintf(stderr, "At least two kinds of tiles are needed on the screen to learn a theme\n");
+        return 1;
+    }
+    if (!saveTheme(options.learn_path.c_str(), theme)) {
+        fprintf(stderr, "Couldn't write %s\n", options.learn_path.c_str());
+        return 1;
+    }
+    std::cout << "Theme saved to " << options.learn_path << ", with:";
+    for (int state = 0; state < TILE_STATES; state++) {
+        if (theme.learned[state]) std::cout << " " << TILE_NAMES[state];
+    }
+    std::cout << std::endl;
+    return 0;
+}
+
+/**
+ * This function plays a game on the board type chosen for the difficulty. It stops as soon as the game
+ * is over.
+ * @param board Board to be used, with every tile undiscovered
+ * @param options Command line options
+ * @param watch Game watch, telling how the game ended
+ * @return returns the GAME_STATE at the end. IN_PROGRESS means the game was given up, with nothing left to decide
+ */
+template <typename BoardT>
+GAME_STATE playGame(BoardT& board, const Options& options, GameWatch& watch) {
     // Setting and initializing variables
     int Width = 0;
     int Height = 0;
     int Bpp = 0;
     int x, y;
-    std::vector<std::vector<char>>* board = new std::vector<std::vector<char>>(board_size_y, std::vector<char>(board_size_x));
     std::vector<std::uint8_t> Pixels;
     Display *display;
     Window root;
     
     // Restart game by clicking on the board's smiling face
     // Smiling face's position
-    x=150+(board_size_x-9)*12.666;
+    x=150+(board.cols()-9)*12.666;
     y=265;
     display = XOpenDisplay(nullptr);
     root = DefaultRootWindow(display);
@@ -745,152 +3099,273 @@ int main (int argc, const char * argv[]) {
     // With the game created, let's collect the image from it
     ImageFromDisplay(Pixels, Width, Height, Bpp);
     Mat img = Mat(Height, Width, Bpp > 24 ? CV_8UC4 : CV_8UC3, &Pixels[0]);
+    // The face of a game in progress, to tell when it changes
+    watch.smiley = readSmiley(img, board.cols(), watch.origin);
 
     // Create the board for ease the search for bombs and safe-tiles
-    int i = 0;
-    int j = 0;
-    // TODO: These offsets are empiric (Firefox w/ 80% zoom). Needs to be updated to work regardless the
-    //       table size
-    // This nested-for run through every pixel in a row in order to collect the non-gray colors. Once the tile counter
-    // reaches its stop count, then set the tile number based on the non-gray average pixels.
-    for (int offset_row=318; offset_row < 530+(board_size_y-9)*25; offset_row += 25) {
-        j = 0;
-        int tile_counter = 0;
-        Vec4b real_color = {0, 0, 0, 0};
-        int counter = 0;
-        for (int offset=34; offset<260+(board_size_x-9)*25; offset += 1) {
-            // The iteration occurs for every tile's center.
-            int x = offset;
-            int y = offset_row;
-
-            // Get the current pixel color
-            Vec4b current_color = img.at<Vec4b>(y,x);
-
-            // If tile counter is 25, or if it reaches the end of the row, then set the color.
-            if (tile_counter == 25 || ((260+(board_size_x-9)*25)) - offset <= 1) {
-                tile_counter = 0;
-                COLOR color_verdict;
-                if (counter > 0) {
-                    color_verdict = colorIdentifier(real_color);
-                    printf("NEW Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, real_color.val[3],real_color.val[2],real_color.val[1], real_color.val[0], color_verdict);
-                } else {
-                    // In case counter was never increased, it means only grey pixels were collected.
-                    // Force tile as a light gray
-                    color_verdict = LIGHT_GRAY;
-                    printf("NEW Position: %i %i at x:%i y:%i :FORCED LIGHT GRAY, VERDICT: %i\n", i+1, j+1, x, y, color_verdict);
-                }
-                real_color = {0, 0, 0, 0};
-                counter = 0;
-                // If it was a color, then just set it in the board. Otherwise, check if the tile is one that was clicked
-                // or not.
-                if (color_verdict) {
-                    board->at(i).at(j) = (char)(48+color_verdict);
-                } else {
-                    // Need to know if tile was cliked, or not... The distinguishment will be done based on
-                    // the information that an unclicked-tile has a white pixel range on its border.
-                    // Begin at the tile's border
-                    int old_x = x;
-                    x = 34+25*j;
-                    while(x <= 34+25*(j+1)) {
-                        // Redo the average routine and color identification
-                        Vec4b color_intermediate = pixelAverage(img, x, y, 0);
-                        color_verdict = colorIdentifier(color_intermediate);
-                        printf("INTERMEDIATE Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, color_intermediate.val[3],color_intermediate.val[2],color_intermediate.val[1], color_intermediate.val[0], color_verdict);
-
-                        // If this a white pixel, it means this is an unclicked tile.
-                        if (color_verdict == WHITE) {
-                            board->at(i).at(j) = 'E';
-                            break;
-                        } else if (34+25*(j+1)-x < 1) {
-                            board->at(i).at(j) = '0';
-                            break;
+    const Theme* theme = options.theme.ready ? &options.theme : nullptr;
+    if (theme != nullptr) {
+        // The theme's signatures read every tile from a few pixels
+        parseBoard(img, board, true, BoardOrigin(), theme);
+    } else {
+        int i = 0;
+        int j = 0;
+        // TODO: These offsets are empiric (Firefox w/ 80% zoom). Needs to be updated to work regardless the
+        //       table size
+        // This nested-for run through every pixel in a row in order to collect the non-gray colors. Once the tile counter
+        // reaches its stop count, then set the tile number based on the non-gray average pixels.
+        for (int offset_row=318; offset_row < 530+(board.rows()-9)*25; offset_row += 25) {
+            j = 0;
+            int tile_counter = 0;
+            Vec4b real_color = {0, 0, 0, 0};
+            int counter = 0;
+            for (int offset=34; offset<260+(board.cols()-9)*25; offset += 1) {
+                // The iteration occurs for every tile's center.
+                int x = offset;
+                int y = offset_row;
+
+                // Get the current pixel color
+                Vec4b current_color = img.at<Vec4b>(y,x);
+
+                // If tile counter is 25, or if it reaches the end of the row, then set the color.
+                if (tile_counter == 25 || ((260+(board.cols()-9)*25)) - offset <= 1) {
+                    tile_counter = 0;
+                    COLOR color_verdict;
+                    if (counter > 0) {
+                        color_verdict = colorIdentifier(real_color);
+                        printf("NEW Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, real_color.val[3],real_color.val[2],real_color.val[1], real_color.val[0], color_verdict);
+                    } else {
+                        // In case counter was never increased, it means only grey pixels were collected.
+                        // Force tile as a light gray
+                        color_verdict = LIGHT_GRAY;
+                        printf("NEW Position: %i %i at x:%i y:%i :FORCED LIGHT GRAY, VERDICT: %i\n", i+1, j+1, x, y, color_verdict);
+                    }
+                    real_color = {0, 0, 0, 0};
+                    counter = 0;
+                    // If it was a color, then just set it in the board. Otherwise, check if the tile is one that was clicked
+                    // or not.
+                    if (color_verdict) {
+                        board.at(i, j) = (char)(48+color_verdict);
+                    } else {
+                        // Need to know if tile was cliked, or not... The distinguishment will be done based on
+                        // the information that an unclicked-tile has a white pixel range on its border.
+                        // Begin at the tile's border
+                        int old_x = x;
+                        x = 34+25*j;
+                        while(x <= 34+25*(j+1)) {
+                            // Redo the average routine and color identification
+                            Vec4b color_intermediate = pixelAverage(img, x, y, 0);
+                            color_verdict = colorIdentifier(color_intermediate);
+                            printf("INTERMEDIATE Position: %i %i at x:%i y:%i : %i, %i, %i, %i, VERDICT: %i\n", i+1, j+1, x, y, color_intermediate.val[3],color_intermediate.val[2],color_intermediate.val[1], color_intermediate.val[0], color_verdict);
+
+                            // If this a white pixel, it means this is an unclicked tile.
+                            if (color_verdict == WHITE) {
+                                board.at(i, j) = 'E';
+                                break;
+                            } else if (34+25*(j+1)-x < 1) {
+                                board.at(i, j) = '0';
+                                break;
+                            }
+                            x++;
                         }
-                        x++;
+                        x = old_x;
                     }
-                    x = old_x;
-                }
-                j++;
-            } else {
-                if (current_color.val[2] > 110 && current_color.val[1] > 110 && current_color.val[0] > 110) {
-                    // That's a light grey, skip it to avoid influenciate in the average.
-                    tile_counter++;
-                    continue;
+                    j++;
                 } else {
-                    counter++;
-                    for (int aux = 0; aux < 4; aux++) {
-                        // That's a continuous way to get the average throughout the for-loop. Given Vec4b limitations,
-                        // this approach was chosen in despite of only dividing the values at the end of the tile counter
-                        real_color.val[aux] = (real_color.val[aux]*(counter-1) + current_color.val[aux])/(counter);
+                    if (current_color.val[2] > 110 && current_color.val[1] > 110 && current_color.val[0] > 110) {
+                        // That's a light grey, skip it to avoid influenciate in the average.
+                        tile_counter++;
+                        continue;
+                    } else {
+                        counter++;
+                        for (int aux = 0; aux < 4; aux++) {
+                            // That's a continuous way to get the average throughout the for-loop. Given Vec4b limitations,
+                            // this approach was chosen in despite of only dividing the values at the end of the tile counter
+                            real_color.val[aux] = (real_color.val[aux]*(counter-1) + current_color.val[aux])/(counter);
+                        }
                     }
                 }
+                tile_counter++;
             }
-            tile_counter++;
+            i++;
         }
-        i++;
     }
 
     // Print the initial parsed board
     std::cout << "Initial parsed board:" << std::endl;
-    printBoard(*board);
+    printBoard(board);
     std::cout << std::endl;
-
-    // This vector contains the tiles which were visited, and which there's nothing else to do with them.
-    // So, we'll avoid visit them after they are done.
-    std::vector<std::vector<int>> visited;
-    std::vector<std::vector<int>> pivots_visited;
-    bool board_stalled = false;
-    // This major for-loop works for run over the board multiple times
-    for (int k = 0; k < 50; k++) {
-        int board_changes = 0;
-        for (int i = 0; i < board_size_y; i++) {
-            for (int j = 0; j < board_size_x; j++) {
-                // No need to check tiles undiscovered (E), empty (0) or with bombs marked (M)
-                // std::cout << "Checking board with i: " << i << " and j: " << j << std::endl;
-                if (board->at(i).at(j) != 'E' && board->at(i).at(j) != '0' && board->at(i).at(j) != 'M') {
-                    // Do not check tiles whieh are inside the visited-array
-                    std::vector<int> aux = {i, j};
-                    if (std::find(visited.begin(), visited.end(), aux) == visited.end() || 
-                        (board_stalled && std::find(pivots_visited.begin(), pivots_visited.end(), aux) == pivots_visited.end())) {
-                        // Let's try to mark some bombs, or free tiles
-                        STRATEGY strategy = board_stalled ? PIVOT : SIMPLE;
-                        if (markBombs(*board, i, j, strategy)) {
-                            // In case the board was updated, then check if the tile is no-longer needed,
-                            // and if so, add it to visited-array
-                            if (strategy == SIMPLE) {
-                                auto after_marking = surroundingTiles(*board, i, j, {'E'});
-                                std::cout << "After checking/marking position " << i+1 << " " << j+1 << " the amount of E's is: " << std::to_string(after_marking.size()) << std::endl;
-                                if (after_marking.size() == 0) visited.emplace_back(aux);
-                            } else if (strategy == PIVOT) {
-                                // Pivoting worked! Let's empty the list, because it can led to other
-                                // pivots to work now. Moreover, the board is no longer stalled (at least in first glance).
-                                pivots_visited = {};
-                                std::cout << "Emptying the pivots_visited vector" << std::endl;
-                                board_stalled = false;
-                            }
-                            board_changes++;
-                        } else {
-                            if (strategy == PIVOT) {
-                                // Pivoting failed. Add it to the visited list.
-                                pivots_visited.emplace_back(aux);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        if (!board_changes) {
-            // Throughout an entire board run, nothing was changed with the SIMPLE strategy.
-            // Let's switch to the PIVOT one.
-            board_stalled = true;
-        }
+    if (watchGame(img, board, watch) != IN_PROGRESS) return watch.state;
+
+    SolverState state(board.size());
+    state.mines = watch.mines;
+    Planner planner;
+    planner.flags = options.flags;
+    // The pointer was left at the first click
+    planner.pointer_x = 1;
+    planner.pointer_y = 2;
+    if (options.pipelined) {
+        solvePipelined(board, state, planner, theme, &watch);
+    } else {
+        Speculator<BoardT> speculator;
+        // Run over the board as many times as needed, until the game is over
+        solveGame(board, state, planner, [&](const std::vector<Move>& planned) {
+            executeMoves(board, planned, theme, &watch);
+            return watch.state;
+        }, options.speculate ? &speculator : nullptr);
+        if (options.speculate) std::cout << "Speculation: " << speculator.hits << " of " << speculator.speculated << " batches had the next run ready" << std::endl;
     }
 
     // Print the final board.
     std::cout << "Final board!" << std::endl;
-    updateBoard(*board);
+    updateBoard(board, theme, &watch);
     std::cout << std::endl;
+    return watch.state;
+}
 
-    // TODO: Return 1 if the board contains any 'E', or if a Bomb was caught.
-    // Returning 0 must only occur when the game is finished with victory.
-    return 0;
-}
\ No newline at end of file
+/**
+ * This function plays games on the board type chosen for the difficulty, restarting the game through its
+ * smiling face until the session is over, and then prints the session statistics
+ * @param board Board to be used, with every tile undiscovered
+ * @param options Command line options
+ * @return returns 0 when every game was won, 1 otherwise
+ */
+template <typename BoardT>
+int play(BoardT& board, const Options& options) {
+    if (options.learn_path.size() > 0) return learnFromScreen(board, options);
+    // Many boards on the screen are played on their own way
+    if (options.find_boards || options.origins.size() > 0) return playBoards(board, options);
+
+    typedef std::chrono::steady_clock Clock;
+    const BoardT empty = board;
+    Session session;
+    Clock::time_point session_start = Clock::now();
+    while (keepPlaying(options, session.games, 1, std::chrono::duration<double>(Clock::now() - session_start).count())) {
+        board = empty;
+        GameWatch watch;
+        watch.mines = options.mines;
+        Clock::time_point game_start = Clock::now();
+        GAME_STATE result = playGame(board, options, watch);
+        double seconds = std::chrono::duration<double>(Clock::now() - game_start).count();
+        session.record(result, seconds);
+        printf("Game %d: %s in %.1fs\n", session.games, GAME_STATE_NAMES[result], seconds);
+    }
+    session.print(std::chrono::duration<double>(Clock::now() - session_start).count());
+    // Only a session where every game was won is a success
+    return session.games > 0 && session.won == session.games ? 0 : 1;
+}
+
+// The benchmarks (bench.cpp) include this file and bring their own main()
+#ifndef MINESWEEPER_NO_MAIN
+/**
+ * That's the main function, where the program starts
+ * @param argc Amount of arguments
+ * @param argv Array with arguments
+ * @return returns 0 when every game was won, 1 otherwise
+ */
+int main (int argc, const char * argv[]) {
+    // With --pipeline, Xlib is used from several threads. This has to be the first Xlib call of the program.
+    XInitThreads();
+
+    // Working with the first argument. It should be within a given range to choose the
+    // correct puzzle difficulty. Right now, only the following ones are supported:
+    // TABLE SIZES:
+    // BEGINNER     :  9x9
+    // INTERMEDIATE : 16x16
+    // EXPERT       : 16x30
+    // CUSTOM       : any size, given by --size
+
+    // The offsets, and position in screen are all empiric and based on a monitor with:
+    // Height : 1080px
+    // Width : 3286px (2 monitors)
+    // Firefox browser with 80% zoom.
+    DIFFICULTY difficulty;
+    if (argc > 1) {
+        switch (atoi(argv[1])) {
+            case 0:
+                difficulty = BEGINNER;
+                break;
+            case 1:
+                difficulty = INTERMEDIATE;
+                break;
+            case 2:
+                difficulty = EXPERT;
+                break;
+            case 3:
+                difficulty = CUSTOM;
+                break;
+            default:
+                difficulty = BEGINNER;
+                break;
+        }
+    } else {
+        difficulty = BEGINNER;
+    }
+    std::cout << "Difficulty is: " << difficulty << std::endl;
+    // The other arguments are optional flags:
+    // --pipeline : capture, recognition, solving and actions run at the same time on separate threads
+    // --no-flag  : bombs are only tracked internally, never marked on screen
+    // --size WxH : board width and height for the CUSTOM difficulty. It's 9x9 by default
+    // --find-boards : find every board on the screen, and play them all at once
+    // --board X,Y   : play a board with its origin at X,Y, along with any other. It can be repeated
+    //                 With many boards, --pipeline isn't used
+    // --theme FILE  : read tiles from the glyph signatures in FILE, learned with --learn-theme
+    // --learn-theme FILE : learn the glyph signatures of the board on the screen, and save them to FILE
+    // --labels FILE : actual tiles on the screen for --learn-theme, as printBoard() shows them
+    // --games N     : play N games, restarting through the smiling face. It's one game on every board by default
+    // --minutes M   : play new games until M minutes have passed
+    // --mines N     : amount of bombs, to tell a win apart on CUSTOM boards
+    // --speculate   : solve ahead of time for every number the tiles being revealed can show
+    Options options;
+    int board_size_x = 9;
+    int board_size_y = 9;
+    for (int arg = 2; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--pipeline") == 0) options.pipelined = true;
+        else if (strcmp(argv[arg], "--no-flag") == 0) options.flags = false;
+        else if (strcmp(argv[arg], "--speculate") == 0) options.speculate = true;
+        else if (strcmp(argv[arg], "--find-boards") == 0) options.find_boards = true;
+        else if (strcmp(argv[arg], "--theme") == 0 && arg+1 < argc) {
+            if (!loadTheme(argv[++arg], options.theme)) {
+                fprintf(stderr, "Couldn't load the theme from %s\n", argv[arg]);
+                return 1;
+            }
+        } else if (strcmp(argv[arg], "--learn-theme") == 0 && arg+1 < argc) {
+            options.learn_path = argv[++arg];
+            // An existing theme is completed, not replaced
+            loadTheme(argv[arg], options.theme);
+        } else if (strcmp(argv[arg], "--labels") == 0 && arg+1 < argc) options.labels_path = argv[++arg];
+        else if (strcmp(argv[arg], "--games") == 0 && arg+1 < argc) options.games = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "--minutes") == 0 && arg+1 < argc) options.minutes = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "--mines") == 0 && arg+1 < argc) options.mines = atoi(argv[++arg]);
+        else if (strcmp(argv[arg], "--board") == 0 && arg+1 < argc) {
+            BoardOrigin origin;
+            sscanf(argv[++arg], "%d,%d", &origin.x, &origin.y);
+            options.origins.push_back(origin);
+        }
+        else if (strcmp(argv[arg], "--size") == 0 && arg+1 < argc) sscanf(argv[++arg], "%dx%d", &board_size_x, &board_size_y);
+    }
+
+    // Standard sizes get a board built at compile time, the others the generic one
+    switch (difficulty) {
+        case INTERMEDIATE: {
+            IntermediateBoard board;
+            if (options.mines == 0) options.mines = 40;
+            return play(board, options);
+        }
+        case EXPERT: {
+            ExpertBoard board;
+            if (options.mines == 0) options.mines = 99;
+            return play(board, options);
+        }
+        case CUSTOM: {
+            DynamicBoard board(board_size_y, board_size_x);
+            return play(board, options);
+        }
+        default: {
+            BeginnerBoard board;
+            if (options.mines == 0) options.mines = 10;
+            return play(board, options);
+        }
+    }
+}
+#endif